@@ -0,0 +1,24 @@
+# FindZSTD - locate zstd library for compressed model input.
+#
+# This module defines the following variables (on success):
+# ZSTD_INCLUDE_DIRS - where to find zstd.h
+# ZSTD_LIBRARIES - library to link
+# ZSTD_FOUND - if the library was successfully located
+#
+# Search can be customized with ZSTD_ROOT_DIR cmake or environment variable.
+
+find_path(ZSTD_INCLUDE_DIR zstd.h
+	HINTS ${ZSTD_ROOT_DIR} $ENV{ZSTD_ROOT_DIR}
+	PATH_SUFFIXES include)
+find_library(ZSTD_LIBRARY NAMES zstd zstd_static
+	HINTS ${ZSTD_ROOT_DIR} $ENV{ZSTD_ROOT_DIR}
+	PATH_SUFFIXES lib)
+
+include(FindPackageHandleStandardArgs)
+find_package_handle_standard_args(ZSTD DEFAULT_MSG ZSTD_LIBRARY ZSTD_INCLUDE_DIR)
+
+if(ZSTD_FOUND)
+	set(ZSTD_INCLUDE_DIRS ${ZSTD_INCLUDE_DIR})
+	set(ZSTD_LIBRARIES ${ZSTD_LIBRARY})
+endif()
+mark_as_advanced(ZSTD_INCLUDE_DIR ZSTD_LIBRARY)
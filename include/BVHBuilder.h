@@ -1,26 +1,51 @@
 #pragma once
 #include <vector>
+#include <cstdint>
 #include <fwd.hpp> //GLM
 #include <functional>
 
 struct Triangle;
 struct Node;
+struct Ray;
+struct Hit;
+struct Frustum;
+class IndexedMesh;
+
+enum class TriangleIntersect
+{
+	Classic,     // Moller-Trumbore, edges every test and |det| < 1e-4 rejected
+	Precomputed, // Moller-Trumbore with stored vertex and edges
+	Watertight   // Woop, Benthin, Wald 2013, no holes on shared edges
+};
+
 class BVHBuilder
 {
 public:
 	BVHBuilder();
+	~BVHBuilder();
 	void build(std::vector<float> const& vertexRaw);
+	void build(IndexedMesh const& mesh); // triangle index is index of mesh triangle
 	void travel(glm::vec3& origin, glm::vec3& direction, glm::vec3& color, float& minT);
 	void travelCycle(glm::vec3& origin, glm::vec3& direction, glm::vec3& color, float& minT);
-	Node * const bvhToTexture();
-	int getNodesSize();
+	int traceCloseHit(Ray& ray, Hit& hit) const; // same as traceCloseHitV2 in raytracing.frag, thread safe, return visited nodes. Normal is read by MeshAttributes
+	int traceCloseHit(Ray& ray, Hit& hit, int const* startNodes, int startCount) const; // start from nodes of collectFrustumNodes
+	void collectFrustumNodes(Frustum const& frustum, std::vector<int>& nodes) const; // nodes for every ray inside frustum, near first
+	void setTriangleIntersect(TriangleIntersect mode);
+	void getBounds(glm::vec3& min, glm::vec3& max) const;
+	void packNodes(std::vector<uint32_t>& texels) const; // 2 RGBA32UI texels per node for GPU
+	int getNodeCount() const;
+	int getTreeDepth() const; // levels of nodes, root is 1
 	std::vector<Node> getNodes();
 private:
-	void buildRecurcive(int nodeIndex, std::vector<Triangle>const& vecTriangle);
+	void buildTree();
+	void buildRecurcive(int nodeIndex, int* begin, int* end); // range of triangle references, reordered in place
 	bool travelRecurcive(Node& node, glm::vec3& origin, glm::vec3& direction, glm::vec3& color, float& minT);
 	bool travelStack(Node& node, glm::vec3& origin, glm::vec3& direction, glm::vec3& color, float& minT);
-	int  texSize;
+	void precomputeTriangles();
+	int  treeDepth;
+	TriangleIntersect triangleIntersect;
 	std::vector<Node> nodeList;
 	std::vector<Triangle> vecTriangle;
+	std::vector<glm::vec3> triangleData; // 3 vec3 per triangle, layout depends on triangleIntersect
 };
 
@@ -0,0 +1,18 @@
+#pragma once
+#include <string>
+#include <fwd.hpp> //GLM
+
+class BVHBuilder;
+class MeshAttributes;
+class ThreadPool;
+
+// Headless measurements, results printed to std::cout
+namespace Benchmark
+{
+	// Random direction rays from surface points seen by camera, traced as is and reordered by RayStream
+	void rayStream(BVHBuilder const& bvh, MeshAttributes const& attributes, ThreadPool& pool, glm::vec3 const& location, int rayCount, int repeatCount);
+	// MB/s of ModelLoader::Obj and ModelLoader::ObjMapped single thread and on pool, outputs are compared
+	void objLoader(ThreadPool& pool, std::string const& filePath, int repeatCount);
+	// Peak resident set of process, never decrease so measure one thing per process
+	double peakMemoryMB();
+};
@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <glm.hpp>
+
+class BVHBuilder;
+class MeshAttributes;
+class ThreadPool;
+
+// Headless copy of raytracing.frag: same camera and normal shading, frame split in tiles
+class CpuRenderer
+{
+public:
+	CpuRenderer(BVHBuilder const& bvh, MeshAttributes const& attributes, int width, int height, int tileSize = 16);
+	void render(ThreadPool& pool, glm::vec3 const& location, glm::mat3 const& viewToWorld);
+	void setFrustumCulling(bool enable); // one BVH descent per tile, rays start from nodes inside tile frustum
+	std::vector<uint8_t> const& getImage() const; // RGB, top row first
+	double getNodeVisitsPerRay() const; // for last render
+	int getWidth() const;
+	int getHeight() const;
+
+private:
+	int64_t renderTile(int tileIndex, glm::vec3 const& location, glm::mat3 const& viewToWorld);
+	glm::vec3 viewDirection(glm::vec2 const& fragCoord, glm::mat3 const& viewToWorld) const;
+	BVHBuilder const& bvh;
+	MeshAttributes const& attributes;
+	int width;
+	int height;
+	int tileSize;
+	int tileCountX;
+	int tileCountY;
+	bool frustumCulling;
+	int64_t nodeVisitCount;
+	std::vector<uint8_t> image;
+};
@@ -0,0 +1,51 @@
+#pragma once
+#include <string>
+#include <cstdio>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+// Gzip (.gz) or zstd (.zst) file decompressed on own thread in large blocks, reader takes them in order.
+// At most MaxQueuedBlocks wait, so decompression runs ahead of parser but the queue stay bounded,
+// what reader keeps of taken blocks is up to it.
+// Codecs exist only if build found zlib (HAVE_ZLIB) or zstd (HAVE_ZSTD)
+class DecompressStream
+{
+public:
+	static constexpr size_t BlockSize = 4 * 1024 * 1024;
+	static constexpr size_t MaxQueuedBlocks = 4;
+
+	explicit DecompressStream(std::string const& filePath);
+	DecompressStream(DecompressStream const&) = delete;
+	DecompressStream& operator=(DecompressStream const&) = delete;
+	~DecompressStream(); // stop decompression if reader did not take all blocks
+	static bool isCompressed(std::string const& filePath); // by .gz or .zst extension
+	static std::string withoutCompression(std::string const& filePath); // "model.obj.gz" -> "model.obj"
+	bool isOpen() const;
+	bool read(std::vector<char>& block); // next block, false after last one
+	bool isGood() const; // false if data was broken or truncated, valid after read return false
+
+private:
+	enum class Codec
+	{
+		Gzip,
+		Zstd
+	};
+
+	void decompressLoop(std::FILE* file, std::string filePath); // worker thread, close file
+	bool inflateFile(std::FILE* file);
+	bool zstdFile(std::FILE* file);
+	bool pushBlock(std::vector<char>& block); // false if stream is destroyed
+
+	Codec codec;
+	bool isOpenFile;
+	mutable std::mutex mutex;
+	std::condition_variable condition;
+	std::deque<std::vector<char>> blocks;
+	bool isFinished;
+	bool isBroken;
+	bool stop;
+	std::thread worker;
+};
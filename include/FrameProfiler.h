@@ -0,0 +1,74 @@
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <deque>
+#include <chrono>
+#include <fstream>
+
+// Frame time of CPU sections and GPU passes with min/avg/p99 over last reportFrames frames.
+// GPU queries of a frame stay in a ring of RingSize frames and are read only when available, so profiler never waits for GPU.
+// Frame whose queries are not ready when its ring slot is reused is dropped
+class FrameProfiler
+{
+public:
+	static constexpr int RingSize = 4;
+
+	// CPU time from construction to end of scope, added to section of current frame
+	class Scope
+	{
+	public:
+		Scope(FrameProfiler& profiler, int section);
+		Scope(Scope const&) = delete;
+		Scope& operator=(Scope const&) = delete;
+		~Scope();
+
+	private:
+		FrameProfiler& profiler;
+		int section;
+		std::chrono::steady_clock::time_point start;
+	};
+
+	// Empty csvPath: statistics are only printed
+	FrameProfiler(std::vector<std::string> const& cpuSections, std::vector<std::string> const& gpuPasses, int reportFrames, std::string const& csvPath);
+	FrameProfiler(FrameProfiler const&) = delete;
+	FrameProfiler& operator=(FrameProfiler const&) = delete;
+	~FrameProfiler();
+	void beginFrame(); // GL_TIMESTAMP at frame start, GPU frame time is distance between two of them
+	void endFrame();   // collect finished frames, print statistics every reportFrames frames
+	void beginPass(int pass); // GL_TIME_ELAPSED, passes can't nest
+	void endPass();
+	void addTime(int section, double milliseconds);
+	double takePassTime(int pass); // GPU time of pass in newest finished frame, NaN if it was taken already
+
+private:
+	struct Frame
+	{
+		uint32_t timestampQuery;
+		std::vector<uint32_t> passQueries;
+		std::vector<bool> isPassUsed;
+		std::vector<double> cpuTimes;
+		double frameTime;
+	};
+
+	bool isAvailable(Frame const& frame) const;
+	void resolve(Frame const& frame, int64_t number);
+	void addSample(int metric, double milliseconds);
+	void report();
+
+	std::vector<std::string> metricNames; // frame, gpu frame, GPU passes, CPU sections
+	int cpuOffset;
+	int gpuOffset;
+	std::vector<std::deque<double>> samples; // last reportFrames values of each metric
+	std::vector<Frame> ring;
+	std::vector<double> latestPassTimes;
+	int64_t frameNumber;   // frame that is recorded now
+	int64_t resolvedFrame; // oldest frame waiting for GPU
+	int64_t droppedFrames;
+	uint64_t lastTimestamp;
+	int64_t lastTimestampFrame;
+	int reportFrames;
+	int framesSinceReport;
+	std::chrono::steady_clock::time_point frameStart;
+	std::ofstream csv;
+};
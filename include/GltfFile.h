@@ -0,0 +1,39 @@
+#pragma once
+#include <string>
+#include <cstdint>
+#include <cstddef>
+#include "MappedFile.h"
+#include "Json.h"
+
+// View of glTF accessor inside mapped binary chunk, nothing is copied.
+// Element is read with conversion only when asked
+struct GltfAccessor
+{
+	char const* data = nullptr; // first element
+	size_t count = 0;
+	size_t stride = 0;          // bytes between elements
+	int componentType = 0;      // 5120 byte, 5121 ubyte, 5122 short, 5123 ushort, 5125 uint, 5126 float
+	int componentCount = 0;     // 1 SCALAR, 2 VEC2, 3 VEC3, 4 VEC4
+	bool normalized = false;
+
+	bool isValid() const;
+	float getFloat(size_t element, int component) const; // normalized integers are mapped to [0,1] or [-1,1]
+	uint32_t getIndex(size_t element) const;
+};
+
+// Binary glTF 2.0 (.glb): JSON chunk parsed, BIN chunk stay in mapping and accessors point inside it
+class GltfFile
+{
+public:
+	explicit GltfFile(std::string const& filePath);
+	bool isOpen() const;
+	JsonValue const& getJson() const;
+	GltfAccessor getAccessor(int index) const; // invalid view if accessor is missing or out of binary chunk
+
+private:
+	MappedFile file;
+	JsonValue json;
+	char const* binary;
+	size_t binarySize;
+	bool isGood;
+};
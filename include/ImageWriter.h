@@ -0,0 +1,12 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+
+// Write 8 bit RGB image, rows from top to bottom
+namespace ImageWriter
+{
+	bool Ppm(std::string const& filePath, int width, int height, std::vector<uint8_t> const& rgb);
+	bool Png(std::string const& filePath, int width, int height, std::vector<uint8_t> const& rgb); // without compression, no zlib needed
+	bool ByExtension(std::string const& filePath, int width, int height, std::vector<uint8_t> const& rgb);
+};
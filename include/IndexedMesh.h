@@ -0,0 +1,25 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// Unique vertices and 3 indices per triangle, welded by the model loader
+class IndexedMesh
+{
+public:
+	void assign(std::vector<float>&& position, std::vector<float>&& normal, std::vector<float>&& uv, std::vector<uint32_t>&& index); // already welded by loader
+	std::vector<float> const& getPosition() const; // x,y,z per vertex
+	std::vector<float> const& getNormal() const;   // x,y,z per vertex, empty if source has no normal
+	std::vector<float> const& getUV() const;       // u,v per vertex, empty if source has no uv
+	std::vector<uint32_t> const& getIndex() const;
+	std::vector<float> takePosition(); // moved out, mesh has no vertices after
+	std::vector<uint32_t> takeIndex(); // moved out, mesh has no triangles after
+	size_t getVertexCount() const;
+	size_t getTriangleCount() const;
+
+private:
+	std::vector<float> position;
+	std::vector<float> normal;
+	std::vector<float> uv;
+	std::vector<uint32_t> index;
+};
@@ -0,0 +1,41 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <utility>
+
+// Small JSON document for glTF header, numbers are double, object keep member order.
+// Missing key or index give null value, so lookups can be chained
+class JsonValue
+{
+public:
+	enum class Type
+	{
+		Null,
+		Bool,
+		Number,
+		String,
+		Array,
+		Object
+	};
+
+	static bool parse(char const* begin, char const* end, JsonValue& value); // false on syntax error
+	Type getType() const;
+	bool isNull() const;
+	bool getBool(bool defaultValue = false) const;
+	double getNumber(double defaultValue = 0.0) const;
+	int getInt(int defaultValue = 0) const;
+	std::string const& getString() const;
+	size_t size() const; // items of array, members of object
+	bool has(char const* key) const;
+	JsonValue const& operator[](int index) const;
+	JsonValue const& operator[](char const* key) const;
+
+private:
+	friend struct JsonParser;
+	Type type = Type::Null;
+	bool boolean = false;
+	double number = 0.0;
+	std::string string;
+	std::vector<JsonValue> items;
+	std::vector<std::pair<std::string, JsonValue>> members;
+};
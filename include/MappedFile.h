@@ -0,0 +1,24 @@
+#pragma once
+#include <string>
+#include <cstddef>
+
+// Read only memory mapping of whole file, RAII
+class MappedFile
+{
+public:
+	explicit MappedFile(std::string const& filePath);
+	MappedFile(MappedFile const&) = delete;
+	MappedFile& operator=(MappedFile const&) = delete;
+	~MappedFile();
+	bool isOpen() const;
+	char const* data() const;
+	size_t size() const;
+
+private:
+	char const* fileData;
+	size_t fileSize;
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#endif
+};
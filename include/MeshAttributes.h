@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+
+#include <fwd.hpp> //GLM
+
+struct Hit;
+class IndexedMesh;
+class ThreadPool;
+
+// Shading data of every vertex as 4 half floats: octahedral normal and uv, same layout as GPU texture,
+// and geometric normal of every triangle as octahedral 2x16 bit snorm.
+// Read only once per pixel for the closest hit, never inside traversal
+class MeshAttributes
+{
+public:
+	explicit MeshAttributes(IndexedMesh const& mesh); // mesh is referenced, its index is read by resolve
+	MeshAttributes(MeshAttributes const&) = delete;
+	MeshAttributes& operator=(MeshAttributes const&) = delete;
+	// One texel per unique vertex of mesh, without normals sum of adjacent triangle normals (area weighted) is stored.
+	// With pool face normals, per vertex sums and packing run in parallel, result is the same
+	void build(ThreadPool* pool = nullptr);
+	void resolve(Hit& hit) const; // interpolate normal and uv at hit barycentric, face normal if it is degenerate
+	glm::vec3 getFaceNormal(int triangleIndex) const;
+	std::vector<uint16_t> const& getPacked() const;
+	int getVertexCount() const;
+
+private:
+	std::vector<uint16_t> packed;
+	std::vector<uint32_t> faceNormal; // packSnorm2x16 of octEncode per triangle
+	IndexedMesh const& mesh; // index resolve corner vertex of hit triangle
+};
@@ -1,8 +1,27 @@
 #pragma once
 #include <vector>
 #include <string>
+
+class ThreadPool;
+class IndexedMesh;
+// Obj*, Ply and PlyIndexed also read .gz and .zst files, they are decompressed on own thread
+// and parsed block by block while next blocks are decompressed
 namespace ModelLoader
 {
 	void Obj(std::string const& filePath, std::vector<float>& rawVertex, std::vector<float>& rawNormal, std::vector<float>& rawUV);
+	// Same output as Obj: file is mapped, lines counted first for exact reserve, then parsed with from_chars.
+	// With pool the file is split in newline aligned chunks parsed in parallel.
+	// Faces may be v, v/t, v//n or v/t/n with negative indices, polygons are triangulated as fan.
+	// rawNormal and rawUV are empty if any face corner has no vn or vt
+	void ObjMapped(std::string const& filePath, std::vector<float>& rawVertex, std::vector<float>& rawNormal, std::vector<float>& rawUV, ThreadPool* pool = nullptr);
+	// Parse like ObjMapped, but corners are welded by their v/vt/vn index while faces are read, expanded triangle list never exists
+	void ObjIndexed(std::string const& filePath, IndexedMesh& mesh, ThreadPool* pool = nullptr);
+	// PLY ascii, binary little and big endian with vertex and face elements, polygons triangulated as fan.
+	// Same output as Obj, rawNormal and rawUV are empty if vertex has no nx,ny,nz or u,v
+	void Ply(std::string const& filePath, std::vector<float>& rawVertex, std::vector<float>& rawNormal, std::vector<float>& rawUV);
+	void PlyIndexed(std::string const& filePath, IndexedMesh& mesh); // PLY is indexed already, no welding
+	// Binary glTF 2.0: triangle primitives of default scene with node transforms applied, instances are flattened.
+	// Accessors are read in place from mapped file, normal and uv only if every primitive has them
+	void Gltf(std::string const& filePath, IndexedMesh& mesh);
 };
 
@@ -0,0 +1,14 @@
+#pragma once
+#include <cstdint>
+#include <fwd.hpp> //GLM
+
+// Compact vertex attribute encodings shared by CPU and shaders
+namespace Packing
+{
+	uint16_t floatToHalf(float value);
+	float halfToFloat(uint16_t half);
+	glm::vec2 octEncode(glm::vec3 const& normal); // unit vector to [-1, 1]^2 octahedron
+	glm::vec3 octDecode(glm::vec2 const& encoded);
+	uint32_t packSnorm2x16(glm::vec2 const& value); // same as GLSL packSnorm2x16, x in low bits
+	glm::vec2 unpackSnorm2x16(uint32_t packed);
+};
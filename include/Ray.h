@@ -0,0 +1,30 @@
+#pragma once
+#include <glm.hpp>
+
+// CPU side copy of Ray and Hit from shaders/raytracing.frag
+struct Ray
+{
+	glm::vec3 origin;
+	glm::vec3 direction;
+	float tStart;
+	float tEnd;
+};
+
+// Traversal only fills triangleIndex, barycentric and distance, the rest is computed once for the closest hit
+struct Hit
+{
+	glm::vec3 normal;
+	glm::vec3 position;
+	glm::vec2 uv;
+	glm::vec2 barycentric; // weights of second and third vertex
+	float distance;
+	int triangleIndex;
+	bool isHit;
+};
+
+// Pyramid of rays from one origin (tile of primary rays), plane normals point inside
+struct Frustum
+{
+	glm::vec3 origin;
+	glm::vec3 normals[4];
+};
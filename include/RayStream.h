@@ -0,0 +1,20 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <fwd.hpp> //GLM
+
+struct Ray;
+struct Hit;
+class BVHBuilder;
+class ThreadPool;
+
+// Batched CPU queries. Incoherent rays (secondary, random direction) are reordered so that
+// neighbours in the stream have the same direction octant and close origins and visit the same BVH nodes
+namespace RayStream
+{
+	// Direction octant in 3 high bits, Morton code of origin inside scene bounds in 29 low bits
+	uint32_t sortKey(Ray const& ray, glm::vec3 const& boundsMin, glm::vec3 const& boundsMax);
+	void sortOrder(std::vector<Ray> const& rays, glm::vec3 const& boundsMin, glm::vec3 const& boundsMax, std::vector<uint32_t>& order);
+	// hits[i] is result for rays[i] in both modes, reorder only changes the trace order
+	void traceCloseHit(BVHBuilder const& bvh, ThreadPool& pool, std::vector<Ray> const& rays, std::vector<Hit>& hits, bool reorder);
+};
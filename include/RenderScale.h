@@ -0,0 +1,19 @@
+#pragma once
+
+// Fraction of window width and height that is traced, driven by measured GPU time toward frame budget.
+// Trace cost follow pixel count, so wanted scale is scale * sqrt(budget / time). Step is damped because
+// measured time is some frames old, and small changes are ignored so resolution does not flicker
+class RenderScale
+{
+public:
+	RenderScale(double budgetMilliseconds, float minScale = 0.25f, float maxScale = 1.0f);
+	void update(double gpuMilliseconds); // NaN is ignored
+	float getScale() const;
+	int scaled(int size) const; // at least 1 pixel
+
+private:
+	double budget;
+	float minScale;
+	float maxScale;
+	float scale;
+};
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+// Offscreen framebuffer with one texture per color attachment, shown on window by blitToScreen
+class RenderTargetGL
+{
+public:
+	RenderTargetGL(int width, int height, std::vector<uint32_t> const& colorFormats); // GL internal format of each attachment
+	RenderTargetGL(RenderTargetGL const&) = delete;
+	RenderTargetGL& operator=(RenderTargetGL const&) = delete;
+	~RenderTargetGL();
+	void bind(); // draw to all attachments, viewport is whole target
+	void bind(int viewportWidth, int viewportHeight); // viewport is bottom left part of target
+	void blitToScreen(int screenWidth, int screenHeight) const; // attachment 0 to default framebuffer
+	uint32_t getTextureID(int attachment) const;
+	int getWidth() const;
+	int getHeight() const;
+
+private:
+	uint32_t framebufferID;
+	std::vector<uint32_t> textureIDs;
+	int width;
+	int height;
+};
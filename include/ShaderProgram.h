@@ -1,23 +1,63 @@
 #pragma once
 #include <string>
+#include <array>
+#include <tuple>
+#include <map>
+#include <vector>
+#include <unordered_map>
 #include <fwd.hpp>
 #include "TextureGL.h"
+#include "UniformBufferGL.h"
+
+using ShaderDefines = std::map<std::string, std::string>; // name -> value, sorted so same set give same source
+
+// Shader files may #include "file" relative to including file, defines are placed after #version.
+// Uniform locations are read once after link, value equal to last upload is not sent again.
+// Linked program is cached in shaders/cache_<hash>.bin when driver supports program binaries
 class ShaderProgram 
 {
 public:
-	ShaderProgram(std::string const& vertexShaderPath, std::string const& fragmentShaderPath);
+	ShaderProgram(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, ShaderDefines const& defines = {});
 	void bind();
 	void setTexture(std::string const& textureName, uint32_t texID, int texUnitSlot);
 	void setTextureAI(std::string const& textureName, TextureGL const& texture);
 	void setMatrix3x3(std::string const& matrixName, glm::mat3 const& matrix, int count = 1, bool transpose = false);
 	void setVec3(std::string const& vectorName, glm::vec3 const& vector);
 	void setVec2(std::string const& vectorName, glm::vec2 const& vector);
+	void setIVec2(std::string const& vectorName, glm::ivec2 const& vector);
 	void setInt(std::string const& vectorName, int data);
+	void setUniformBlock(std::string const& blockName, UniformBufferGL const& buffer, int bindingPoint); // binding of block is set once
 	int getID();
 	~ShaderProgram();
 
 private:
+	struct Uniform
+	{
+		int location;
+		size_t size = 0;                 // bytes of last value, 0 before first upload
+		std::array<uint32_t, 9> value{}; // mat3 is largest value
+	};
+
+	struct UniformBlock
+	{
+		uint32_t index;
+		int bindingPoint = -1;
+	};
+
+	using ShaderCode = std::array<std::tuple<std::string, int, unsigned int>, 2>; // <shader source code, shader type, shader id>
+
 	std::string loadShaderByFile(std::string const& shaderPath);
+	std::string preprocess(std::string const& shaderPath, int depth = 0); // path relative to resource dir
+	void compileProgram(ShaderCode& shaderCode);
+	static bool isBinarySupported(); // GL 4.1 or ARB_get_program_binary
+	bool loadBinary(std::string const& path);
+	void saveBinary(std::string const& path);
+	void reflectUniforms();
+	int findLocation(std::string const& name) const;
+	int changedLocation(std::string const& name, void const* data, size_t size); // -1 if uniform is missing or value is the same
 	uint32_t programID;
 	int texUnitSlotIndex;
+	std::vector<std::string> sourceFiles; // index is source string number in #line and compile log
+	std::unordered_map<std::string, Uniform> uniforms;
+	std::unordered_map<std::string, UniformBlock> uniformBlocks;
 };
\ No newline at end of file
@@ -1,25 +1,47 @@
 #pragma once
 #include <cstdint>
+#include <cstddef>
 
 enum class TextureGLType
 {
-	VertexDataXYZ
+	VertexDataXYZ,
+	VertexDataHalf4, // 4 half floats per texel, packed vertex attributes
+	IndexUint3,      // 3 vertex index of triangle as integers
+	NodeUint4        // BVH node as 2 texels of 4 integers, see BVHBuilder::packNodes
 };
 
-class TextureGL 
+enum class TextureGLStorage
+{
+	Array2D, // GL_TEXTURE_2D_ARRAY, rows of Utils::dataTextureWidth texels, next layer when rows exceed GL_MAX_TEXTURE_SIZE
+	Buffer   // GL_TEXTURE_BUFFER, linear index
+};
+
+class TextureGL
 {
 public:
-	TextureGL(int width, int height, TextureGLType datatype, const void* data);
+	TextureGL(TextureGLType datatype, TextureGLStorage storage, int texelCount, const void* data);
 	TextureGL(TextureGL&& other);
 	int getWidth();
 	int getHeight();
+	int getLayers();
+	int getWidthShift() const; // texel index to x, y, layer: shift and mask in shader
+	int getLayerShift() const;
+	size_t getMemorySize() const; // bytes on GPU
 	void bind();
 	~TextureGL();
+	static bool isBufferSupported(int texelCount); // RGB32F buffer needs GL 4.0 or ARB_texture_buffer_object_rgb32
 	friend class ShaderProgram;
 
 private:
 	int width;
 	int height;
-	void VertexDataXYZToTexture(int width, int height, const void* data);
+	int layers;
+	int widthShift;
+	int layerShift;
+	void ArrayToTexture(int texelCount, uint32_t internalFormat, uint32_t format, uint32_t type, const void* data);
+	void BufferToTexture(int texelCount, uint32_t internalFormat, const void* data);
 	uint32_t textureID;
+	uint32_t bufferID; // 0 for 2D texture
+	uint32_t target;
+	size_t texelSize;
 };
\ No newline at end of file
@@ -0,0 +1,43 @@
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work stealing pool: every worker owns a queue, takes own tasks from the back
+// and steals from the front of the other queues when its own is empty
+class ThreadPool
+{
+public:
+	explicit ThreadPool(unsigned threadCount = std::thread::hardware_concurrency());
+	~ThreadPool();
+	void submit(std::function<void()> task);
+	void wait(); // block until all submitted tasks are done, caller thread helps
+	void parallelFor(int count, std::function<void(int)> const& task);
+	unsigned getThreadCount() const;
+
+private:
+	struct WorkQueue
+	{
+		std::mutex mutex;
+		std::deque<std::function<void()>> tasks;
+	};
+
+	void workerLoop(unsigned workerIndex);
+	bool popTask(unsigned workerIndex, std::function<void()>& task);
+	void finishTask();
+
+	std::vector<std::unique_ptr<WorkQueue>> queues;
+	std::vector<std::thread> workers;
+	std::mutex wakeMutex;
+	std::condition_variable wakeCondition;
+	std::condition_variable doneCondition;
+	std::atomic<int> queuedTasks;
+	std::atomic<int> unfinishedTasks;
+	std::atomic<unsigned> nextQueue;
+	bool stop;
+};
@@ -0,0 +1,21 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+
+// Uniform buffer for std140 block, whole block is written by one glBufferSubData when content changed
+class UniformBufferGL
+{
+public:
+	explicit UniformBufferGL(size_t size);
+	UniformBufferGL(UniformBufferGL const&) = delete;
+	UniformBufferGL& operator=(UniformBufferGL const&) = delete;
+	~UniformBufferGL();
+	bool update(void const* data); // size bytes given to constructor, false if content is the same
+	void bind(int bindingPoint) const;
+
+private:
+	uint32_t bufferID;
+	std::vector<char> content; // last written bytes
+	bool isWritten;
+};
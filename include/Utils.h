@@ -14,4 +14,25 @@ namespace Utils
 		value++;
 		return value;
 	}
+
+	inline int log2PowerOfTwo(uint32_t value) // exact for powerOfTwo result
+	{
+		int shift = 0;
+		while (value > 1u)
+		{
+			value >>= 1;
+			shift++;
+		}
+		return shift;
+	}
+
+	constexpr uint32_t dataTextureWidth = 4096; // power of two for shift addressing in shader, fit every GL 3.3 GPU
+
+	// Rectangle for texelCount texels in row order: one row up to dataTextureWidth, padding is less than one row
+	inline void dataTextureSize(uint32_t texelCount, int& width, int& height)
+	{
+		width = texelCount < dataTextureWidth ? powerOfTwo(texelCount > 0 ? texelCount : 1) : dataTextureWidth;
+		height = (texelCount + width - 1) / width;
+		height = height > 0 ? height : 1;
+	}
 };
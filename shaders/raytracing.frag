@@ -1,89 +1,60 @@
 #version 330 core
 
 in vec2 fragCoord;
-out vec4 color;
+layout(location = 0) out vec4 color;
+layout(location = 1) out vec4 surface; // normal and hit distance for upsampling, dropped without second attachment
 
-uniform vec3 location;
-uniform vec2 screeResolution;
-uniform mat3 viewToWorld;
-uniform sampler2D texPosition;
-uniform sampler2D texNode;
-uniform int bvhWidth;
-uniform int texPosWidth;
-
-
-//------------------- STRUCT AND LOADER BEGIN -----------------------
-struct Triangle
-{
-    // Position
-    vec3 pos1;
-    vec3 pos2;
-    vec3 pos3;
-};
-struct Node
+// Camera and frame state, written by host once per frame, layout match FrameUniforms in main.cpp
+layout(std140) uniform FrameState
 {
-	int childIsTriangle;
-    int leftChild;
-    int rightChild;
-    vec3 aabbMin;
-    vec3 aabbMax;
+	mat3 viewToWorld;
+	vec3 location;
+	vec2 screeResolution;
 };
 
+const float MissDistance = 10000.0; // ray end, surface distance of background
+uniform vec2 jitter; // subpixel offset of accumulated sample, zero without accumulation
+
+// Variant defines, set by host from BVH statistics and options:
+// STACK_SIZE - traversal stack, BVH depth + 1 so no ray is dropped
+// TRACE_ANY_HIT - stop at first hit found instead of closest one, for occlusion cost
+// SHOW_NODE_VISITS - color is count of visited nodes instead of normal
+#ifndef STACK_SIZE
+#define STACK_SIZE 15
+#endif
+
+#include "scene.glsl"
+
+
+//------------------- STRUCT BEGIN -----------------------
 struct Ray
 {
     vec3 origin;
     vec3 direction;
     float tStart;
     float tEnd;
+    // Watertight test: axis permutation and shear, set by rayPrepare
+    ivec3 k;
+    vec3 shear;
 };
 
+// Traversal only fills triangleIndex, barycentric and distance, the rest is set in hitResolve
 struct Hit
 {
     vec3 normal;
     vec3 position;
     vec2 uv;
+    vec2 barycentric; // weights of pos2 and pos3
+    float distance;
+    int triangleIndex;
     bool isHit;
 };
-
-
-vec2 get2DIndex(int index, int width)
-{
-	int x = index % width;
-    int y = index / width;
-    return vec2(x / float(width), y / float(width));
-}
-
-Node getNode(int index)
-{
-	index = index * 3;
-
-	vec3 integerData = texture(texNode, get2DIndex(index, bvhWidth)).rgb;
-	vec3 aabbMin = texture(texNode, get2DIndex(index + 1, bvhWidth)).rgb;
-	vec3 aabbMax = texture(texNode, get2DIndex(index + 2, bvhWidth)).rgb;
-
-	Node node;
-	node.childIsTriangle = int(integerData.x);
-	node.leftChild = int(integerData.y);
-	node.rightChild = int(integerData.z);
-	node.aabbMin = aabbMin;
-	node.aabbMax = aabbMax;
-	return node;
-}
-
-Triangle getTriangle(int index)
-{
-	index = index * 3;
-	Triangle triangle;
-	triangle.pos1 = texture(texPosition, get2DIndex(index, texPosWidth)).rgb;
-	triangle.pos2 = texture(texPosition, get2DIndex(index + 1, texPosWidth)).rgb;
-	triangle.pos3 = texture(texPosition, get2DIndex(index + 2, texPosWidth)).rgb;
-	return triangle;
-}
-//------------------- STRUCT AND LOADER END -----------------------
+//------------------- STRUCT END -----------------------
 
 //------------------- STACK BEGIN -----------------------
 int countTI = 0;
-int _stack[15];
+int nodeVisits = 0;
+int _stack[STACK_SIZE];
 int _index = -1;
 
 void stackClear()
@@ -98,7 +69,7 @@ int stackSize()
 
 void stackPush(in int node)
 {
-    if(_index > 14	)
+    if(_index >= STACK_SIZE - 1)
         discard;
     _stack[++_index] = node;
  
@@ -128,34 +99,52 @@ bool slabs(in Ray ray, in vec3 minB, in vec3 maxB, inout float localMin) {
     return tminf < ray.tEnd && tminf > ray.tStart;
 }
 
-bool isect_tri(inout Ray ray, in Triangle tri, inout Hit hit ) {
-	vec3 e1 = tri.pos2 - tri.pos1;
-	vec3 e2 = tri.pos3 - tri.pos1;
-	vec3 P = cross(ray.direction, e2);
-	float det = dot(e1, P);
-	if (abs(det) < 1e-4)
-        return false;
+void rayPrepare(inout Ray ray)
+{
+    vec3 absDir = abs(ray.direction);
+    int kz = absDir.x > absDir.y ? (absDir.x > absDir.z ? 0 : 2) : (absDir.y > absDir.z ? 1 : 2);
+    int kx = (kz + 1) % 3;
+    int ky = (kx + 1) % 3;
+    if (ray.direction[kz] < 0.0)
+        ray.k = ivec3(ky, kx, kz); // keep triangle winding
+    else
+        ray.k = ivec3(kx, ky, kz);
+
+    ray.shear = vec3(ray.direction[ray.k.x], ray.direction[ray.k.y], 1.0) / ray.direction[kz];
+}
 
-	float inv_det = 1. / det;
-	vec3 T = (ray.origin - tri.pos1);
-	float u = dot(T, P) * inv_det;
-	if (u < 0.0 || u > 1.0)
+// Watertight ray/triangle (Woop, Benthin, Wald 2013), no double fallback for rays exactly on edge.
+// Only distance, barycentric and triangle index, shading data is read once in hitResolve
+bool isect_tri(inout Ray ray, in Triangle tri, in int index, inout Hit hit) {
+    vec3 A = tri.pos1 - ray.origin;
+    vec3 B = tri.pos2 - ray.origin;
+    vec3 C = tri.pos3 - ray.origin;
+
+    float Ax = A[ray.k.x] - ray.shear.x * A[ray.k.z];
+    float Ay = A[ray.k.y] - ray.shear.y * A[ray.k.z];
+    float Bx = B[ray.k.x] - ray.shear.x * B[ray.k.z];
+    float By = B[ray.k.y] - ray.shear.y * B[ray.k.z];
+    float Cx = C[ray.k.x] - ray.shear.x * C[ray.k.z];
+    float Cy = C[ray.k.y] - ray.shear.y * C[ray.k.z];
+
+    float U = Cx * By - Cy * Bx;
+    float V = Ax * Cy - Ay * Cx;
+    float W = Bx * Ay - By * Ax;
+    if ((U < 0.0 || V < 0.0 || W < 0.0) && (U > 0.0 || V > 0.0 || W > 0.0))
         return false;
 
-	vec3 Q = cross(T, e1);
-	float v = dot(ray.direction, Q) * inv_det;
-	if (v < 0.0 || (v+u) > 1.0)
+    float det = U + V + W;
+    if (det == 0.0)
         return false;
 
-	float tt = dot(e2, Q) * inv_det;
+    float inv_det = 1.0 / det;
+    float tt = (U * A[ray.k.z] + V * B[ray.k.z] + W * C[ray.k.z]) * ray.shear.z * inv_det;
 
     if(ray.tEnd > tt && ray.tStart < tt )
     {
-        vec3 c = vec3(u, v, 1.0 - u - v);
         countTI++;
-        hit.normal = normalize(cross(e1, e2));//(tri.norm1 * c.z + tri.norm2 * c.x + tri.norm3 * c.y);
-        //chit.uv = tri.uv1 * c.z + tri.uv2 * c.x + tri.uv3 * c.y;
-        hit.position = (ray.origin + ray.direction * tt);
+        hit.triangleIndex = index;
+        hit.barycentric = vec2(V, W) * inv_det;
         hit.isHit = true;
         ray.tEnd = tt;
         return true;
@@ -163,11 +152,30 @@ bool isect_tri(inout Ray ray, in Triangle tri, inout Hit hit ) {
     return false;
 }
 
+void hitResolve(in Ray ray, inout Hit hit)
+{
+    if (!hit.isHit)
+        return;
+
+    ivec3 vertex = getTriangleIndex(hit.triangleIndex);
+    vec4 attribute1 = fetchTexel(texAttribute, vertex.x, texPosShift);
+    vec4 attribute2 = fetchTexel(texAttribute, vertex.y, texPosShift);
+    vec4 attribute3 = fetchTexel(texAttribute, vertex.z, texPosShift);
+    vec3 c = vec3(1.0 - hit.barycentric.x - hit.barycentric.y, hit.barycentric);
+
+    hit.normal = normalize(octDecode(attribute1.xy) * c.x + octDecode(attribute2.xy) * c.y + octDecode(attribute3.xy) * c.z);
+    hit.uv = attribute1.zw * c.x + attribute2.zw * c.y + attribute3.zw * c.z;
+    hit.distance = ray.tEnd;
+    hit.position = ray.origin + ray.direction * ray.tEnd;
+}
+
 void traceCloseHitV2(inout Ray ray, inout Hit hit)
 {
     stackClear();
     stackPush(0);
     hit.isHit = false;
+    hit.triangleIndex = -1;
+    hit.normal = vec3(0.0);
     Node select;
     Triangle try;
     float tempt;
@@ -175,6 +183,9 @@ void traceCloseHitV2(inout Ray ray, inout Hit hit)
     while(stackSize() != 0)
     {
         select = getNode(stackPop());
+#ifdef SHOW_NODE_VISITS
+        nodeVisits++;
+#endif
         if(!slabs(ray, select.aabbMin, select.aabbMax, tempt))
             continue;
         
@@ -217,15 +228,20 @@ void traceCloseHitV2(inout Ray ray, inout Hit hit)
         if((select.childIsTriangle & 2) > 0)
         {
             try = getTriangle(select.rightChild);
-            isect_tri(ray, try, hit);
+            isect_tri(ray, try, select.rightChild, hit);
         }
 
         if((select.childIsTriangle & 1) > 0)
         {
             try = getTriangle(select.leftChild);
-            isect_tri(ray, try, hit);
+            isect_tri(ray, try, select.leftChild, hit);
         }
+#ifdef TRACE_ANY_HIT
+        if (hit.isHit)
+            break;
+#endif
     }
+    hitResolve(ray, hit);
 }
 
 mat3 rotationMatrix(vec3 axis, float angle)
@@ -240,41 +256,23 @@ mat3 rotationMatrix(vec3 axis, float angle)
                oc * axis.z * axis.x - axis.y * s,  oc * axis.y * axis.z + axis.x * s,  oc * axis.z * axis.z + c);
 }
 
-void traceCloseFor(inout Ray ray, inout Hit hit)
-{
-	hit.isHit = false;
-
-	Node nod = getNode(2230);
-	float temp = 0;
-
-	//slabs(ray, vec3(-2.3, -5.0, -9.16), vec3(2.3, 5.0, 9), temp);
-	slabs(ray, nod.aabbMin, nod.aabbMax, temp);
-	hit.normal = vec3(0, 0, 0);
-	// if(nod.childIsTriangle == 0)
-	// 	chit.normal = vec3(1, 0, 0);
-	if(temp > 0)
-		hit.normal = vec3(1, 0, 0);
-
-	// for(int i = 0; i< 15216; i++)
-	// {
-	// 	Triangle tri = getTriangle(i);
-	// 	isect_tri(ray, tri, chit);
-	// }
-}
-
 void main() {
-    vec3 viewDir = normalize(vec3((gl_FragCoord.xy - screeResolution.xy*0.5) / screeResolution.y, 1.0));
+    vec3 viewDir = normalize(vec3((gl_FragCoord.xy + jitter - screeResolution.xy*0.5) / screeResolution.y, 1.0));
     vec3 worldDir = viewToWorld * viewDir;
 
     Ray ray;
     ray.direction = worldDir;
     ray.origin = location;
     ray.tStart = 0.0001;
-    ray.tEnd = 10000;
+    ray.tEnd = MissDistance;
+    rayPrepare(ray);
 
     Hit hit;
-    //traceCloseFor(ray, hit);
     traceCloseHitV2(ray, hit);
-    //color = vec4(fragCoord,0.0,1.0);
+#ifdef SHOW_NODE_VISITS
+    color = vec4(vec3(float(nodeVisits) / 128.0), 1.0);
+#else
     color = vec4(0.5+hit.normal*0.5, 1.0);
+#endif
+    surface = vec4(hit.normal, hit.isHit ? hit.distance : MissDistance);
 }
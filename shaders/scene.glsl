@@ -0,0 +1,85 @@
+// Scene data in textures: BVH nodes, triangles and vertex attributes, and their loaders.
+// Host defines BUFFER_TEXTURES when data is in GL_TEXTURE_BUFFER with linear index
+#ifndef SCENE_GLSL
+#define SCENE_GLSL
+
+#ifdef BUFFER_TEXTURES
+#define SceneSampler samplerBuffer
+#define SceneUSampler usamplerBuffer
+#define fetchTexel(tex, index, shift) texelFetch(tex, index)
+#else
+#define SceneSampler sampler2DArray
+#define SceneUSampler usampler2DArray
+#define fetchTexel(tex, index, shift) texelFetch(tex, texelIndex(index, shift), 0)
+#endif
+
+uniform SceneSampler texPosition; // unique vertices
+uniform SceneUSampler texIndex; // 3 vertex index of triangle
+uniform SceneUSampler texNode; // 2 texels per node, see BVHBuilder::packNodes
+uniform SceneSampler texAttribute; // octahedral normal and uv as half floats, same index as texPosition
+uniform ivec2 bvhShift; // log2 of texture width and of texels in layer, 2D textures only
+uniform ivec2 texPosShift;
+uniform ivec2 texIndexShift;
+
+
+struct Triangle
+{
+    // Position
+    vec3 pos1;
+    vec3 pos2;
+    vec3 pos3;
+};
+struct Node
+{
+	int childIsTriangle;
+    int leftChild;
+    int rightChild;
+    vec3 aabbMin;
+    vec3 aabbMax;
+};
+
+// Texel of 1D index for texelFetch, integer only: width and layer size are powers of two so mask and shift replace modulo and division
+ivec3 texelIndex(int index, ivec2 shift)
+{
+	return ivec3(index & ((1 << shift.x) - 1), (index & ((1 << shift.y) - 1)) >> shift.x, index >> shift.y);
+}
+
+Node getNode(int index)
+{
+	uvec4 minData = fetchTexel(texNode, index * 2, bvhShift);
+	uvec4 maxData = fetchTexel(texNode, index * 2 + 1, bvhShift);
+
+	Node node;
+	node.childIsTriangle = int((minData.w >> 31) | ((maxData.w >> 31) << 1));
+	node.leftChild = int(minData.w & 0x7FFFFFFFu);
+	node.rightChild = int(maxData.w & 0x7FFFFFFFu);
+	node.aabbMin = uintBitsToFloat(minData.xyz);
+	node.aabbMax = uintBitsToFloat(maxData.xyz);
+	return node;
+}
+
+ivec3 getTriangleIndex(int index)
+{
+	return ivec3(fetchTexel(texIndex, index, texIndexShift).rgb);
+}
+
+Triangle getTriangle(int index)
+{
+	ivec3 vertex = getTriangleIndex(index);
+	Triangle triangle;
+	triangle.pos1 = fetchTexel(texPosition, vertex.x, texPosShift).rgb;
+	triangle.pos2 = fetchTexel(texPosition, vertex.y, texPosShift).rgb;
+	triangle.pos3 = fetchTexel(texPosition, vertex.z, texPosShift).rgb;
+	return triangle;
+}
+
+// Inverse of Packing::octEncode
+vec3 octDecode(vec2 encoded)
+{
+	vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+	if (n.z < 0.0)
+		n.xy = (1.0 - abs(n.yx)) * vec2(n.x >= 0.0 ? 1.0 : -1.0, n.y >= 0.0 ? 1.0 : -1.0);
+	return normalize(n);
+}
+
+#endif
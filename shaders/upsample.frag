@@ -0,0 +1,43 @@
+#version 330 core
+
+in vec2 fragCoord;
+out vec4 color;
+
+// Traced image is in bottom left renderSize pixels of low resolution targets
+uniform sampler2D lowColor;
+uniform sampler2D lowSurface; // normal xyz, hit distance w, see raytracing.frag
+uniform ivec2 renderSize;
+uniform vec2 windowSize;
+
+const float MissDistance = 10000.0;
+
+// Bilinear taps weighted by similarity to nearest traced pixel, so colors don't blend over silhouettes and creases
+float similarity(vec4 surface, vec4 reference)
+{
+    float depth = exp(-abs(surface.w - reference.w) / (0.05 * reference.w + 0.0001));
+    if (reference.w >= MissDistance)
+        return depth;
+    return depth * pow(max(dot(surface.xyz, reference.xyz), 0.0), 8.0);
+}
+
+void main()
+{
+    vec2 position = gl_FragCoord.xy * vec2(renderSize) / windowSize - 0.5;
+    ivec2 base = ivec2(floor(position));
+    vec2 fraction = position - vec2(base);
+    ivec2 nearest = clamp(ivec2(floor(position + 0.5)), ivec2(0), renderSize - 1);
+    vec4 reference = texelFetch(lowSurface, nearest, 0);
+
+    vec4 sum = vec4(0.0);
+    float weightSum = 0.0;
+    for (int tap = 0; tap < 4; tap++)
+    {
+        ivec2 offset = ivec2(tap & 1, tap >> 1);
+        ivec2 texel = clamp(base + offset, ivec2(0), renderSize - 1);
+        vec2 bilinear = mix(1.0 - fraction, fraction, vec2(offset));
+        float weight = bilinear.x * bilinear.y * similarity(texelFetch(lowSurface, texel, 0), reference);
+        sum += texelFetch(lowColor, texel, 0) * weight;
+        weightSum += weight;
+    }
+    color = weightSum > 0.0001 ? sum / weightSum : texelFetch(lowColor, nearest, 0);
+}
@@ -1,10 +1,22 @@
 #include <glm.hpp>
 #include <algorithm>
 #include <stack>
-#include <Utils.h>
+#include <cstring>
 #include "BVHBuilder.h"
+#include "IndexedMesh.h"
+#include "Ray.h"
 using glm::vec3;
 
+constexpr int TraversalStackSize = 64; // on call frame, deeper tree takes stack from heap
+constexpr int MaxFrustumNodes = 16;
+
+enum class FrustumClass
+{
+	Outside,
+	Intersect,
+	Inside
+};
+
 struct AABB
 {
 private:
@@ -45,17 +57,59 @@ public:
 		return tminf>0.0f;
 	}
 
+	bool slabs(Ray const& ray, float& localMin) const
+	{
+		localMin = 0;
+		if (glm::all(glm::greaterThan(ray.origin, min)) && glm::all(glm::lessThan(ray.origin, max)))
+			return true;
+
+		vec3 t0 = (min - ray.origin) / ray.direction;
+		vec3 t1 = (max - ray.origin) / ray.direction;
+		vec3 tmin = glm::min(t0, t1), tmax = glm::max(t0, t1);
+		float tminf = glm::max(glm::max(tmin.x, tmin.y), tmin.z);
+		float tmaxf = glm::min(glm::min(tmax.x, tmax.y), tmax.z);
+
+		if (tminf > tmaxf)
+			return false;
+
+		localMin = tminf;
+		return tminf < ray.tEnd && tminf > ray.tStart;
+	}
+
 	vec3& getMin() { return min; }
 	vec3& getMax() { return max; }
+	vec3 const& getMin() const { return min; }
+	vec3 const& getMax() const { return max; }
+
+	// Corner farthest along plane normal decide outside, nearest decide inside
+	FrustumClass frustumTest(Frustum const& frustum) const
+	{
+		FrustumClass result = FrustumClass::Inside;
+		for (vec3 const& normal : frustum.normals)
+		{
+			vec3 farCorner(normal.x > 0 ? max.x : min.x, normal.y > 0 ? max.y : min.y, normal.z > 0 ? max.z : min.z);
+			vec3 nearCorner(normal.x > 0 ? min.x : max.x, normal.y > 0 ? min.y : max.y, normal.z > 0 ? min.z : max.z);
+			if (glm::dot(normal, farCorner - frustum.origin) < 0.0f)
+				return FrustumClass::Outside;
+			if (glm::dot(normal, nearCorner - frustum.origin) < 0.0f)
+				result = FrustumClass::Intersect;
+		}
+		return result;
+	}
+
+	float distance(vec3 const& point) const
+	{
+		return glm::length(glm::clamp(point, min, max) - point);
+	}
 };
 
 struct Node
 {
 	/*bool leftChildIsTriangle;
 	bool rightChildIsTriangle;*/
-	float childIsTriangle;
-	float leftChild;
-	float rightChild;
+	int childIsTriangle; // integer, float index is exact only up to 2^24
+	int leftChild;
+	int rightChild;
 	AABB aabb;
 
 	Node() : /*leftChildIsTriangle(false), rightChildIsTriangle(false)*/ childIsTriangle(0), leftChild(-1), rightChild(-1) {}
@@ -117,6 +171,44 @@ public:
 		return true;
 	}
 
+	// Only distance and barycentric, normal is computed once for the closest hit
+	bool rayIntersect(Ray& ray, glm::vec2& barycentric) const
+	{
+		vec3 e1 = vertex2 - vertex1;
+		vec3 e2 = vertex3 - vertex1;
+		vec3 P = glm::cross(ray.direction, e2);
+		float det = glm::dot(e1, P);
+
+		if (glm::abs(det) < 1e-4f)
+			return false;
+
+		float inv_det = 1.0f / det;
+		vec3 T = ray.origin - vertex1;
+		float u = glm::dot(T, P) * inv_det;
+
+		if (u < 0.0f || u > 1.0f)
+			return false;
+
+		vec3 Q = glm::cross(T, e1);
+		float v = glm::dot(ray.direction, Q) * inv_det;
+
+		if (v < 0.0f || (v + u) > 1.0f)
+			return false;
+
+		float tt = glm::dot(e2, Q) * inv_det;
+
+		if (tt >= ray.tEnd || tt <= ray.tStart)
+			return false;
+
+		ray.tEnd = tt;
+		barycentric = glm::vec2(u, v);
+		return true;
+	}
+
+	vec3 const& getVertex1() const { return vertex1; }
+	vec3 const& getVertex2() const { return vertex2; }
+	vec3 const& getVertex3() const { return vertex3; }
+
 	vec3& getCenter() { return center; }
 	AABB& getAABB() { return aabb; }
 	int getIndex() { return index; }
@@ -141,13 +233,114 @@ private:
 	}
 };
 
-BVHBuilder::BVHBuilder() {}
+// Moller-Trumbore on precomputed vertex1, edge1, edge2, only the exact det == 0 is rejected
+static bool intersectPrecomputed(Ray& ray, vec3 const* triangle, glm::vec2& barycentric)
+{
+	vec3 P = glm::cross(ray.direction, triangle[2]);
+	float det = glm::dot(triangle[1], P);
 
-void BVHBuilder::build(std::vector<float> const& vertexRaw)
+	if (det == 0.0f)
+		return false;
+
+	float inv_det = 1.0f / det;
+	vec3 T = ray.origin - triangle[0];
+	float u = glm::dot(T, P) * inv_det;
+
+	if (u < 0.0f || u > 1.0f)
+		return false;
+
+	vec3 Q = glm::cross(T, triangle[1]);
+	float v = glm::dot(ray.direction, Q) * inv_det;
+
+	if (v < 0.0f || (v + u) > 1.0f)
+		return false;
+
+	float tt = glm::dot(triangle[2], Q) * inv_det;
+
+	if (tt >= ray.tEnd || tt <= ray.tStart)
+		return false;
+
+	ray.tEnd = tt;
+	barycentric = glm::vec2(u, v);
+	return true;
+}
+
+// Per ray part of the watertight test: axis with the largest direction become z, shear to +z
+struct WatertightRay
 {
-	size_t nodeSize = sizeof(Node);
-	nodeList.push_back(Node());
+	int kx;
+	int ky;
+	int kz;
+	vec3 shear;
+
+	WatertightRay(vec3 const& direction)
+	{
+		vec3 absDir = glm::abs(direction);
+		kz = absDir.x > absDir.y ? (absDir.x > absDir.z ? 0 : 2) : (absDir.y > absDir.z ? 1 : 2);
+		kx = (kz + 1) % 3;
+		ky = (kx + 1) % 3;
+
+		// Keep triangle winding
+		if (direction[kz] < 0.0f)
+			std::swap(kx, ky);
+
+		shear = vec3(direction[kx] / direction[kz], direction[ky] / direction[kz], 1.0f / direction[kz]);
+	}
+};
+
+// Woop, Benthin, Wald "Watertight Ray/Triangle Intersection" 2013 on vertex1, vertex2, vertex3
+static bool intersectWatertight(Ray& ray, WatertightRay const& wray, vec3 const* triangle, glm::vec2& barycentric)
+{
+	vec3 A = triangle[0] - ray.origin;
+	vec3 B = triangle[1] - ray.origin;
+	vec3 C = triangle[2] - ray.origin;
+
+	float Ax = A[wray.kx] - wray.shear.x * A[wray.kz];
+	float Ay = A[wray.ky] - wray.shear.y * A[wray.kz];
+	float Bx = B[wray.kx] - wray.shear.x * B[wray.kz];
+	float By = B[wray.ky] - wray.shear.y * B[wray.kz];
+	float Cx = C[wray.kx] - wray.shear.x * C[wray.kz];
+	float Cy = C[wray.ky] - wray.shear.y * C[wray.kz];
+
+	float U = Cx * By - Cy * Bx;
+	float V = Ax * Cy - Ay * Cx;
+	float W = Bx * Ay - By * Ax;
+
+	// Ray exactly on edge, float is not enough to decide the side
+	if (U == 0.0f || V == 0.0f || W == 0.0f)
+	{
+		U = (float)((double)Cx * By - (double)Cy * Bx);
+		V = (float)((double)Ax * Cy - (double)Ay * Cx);
+		W = (float)((double)Bx * Ay - (double)By * Ax);
+	}
+
+	if ((U < 0.0f || V < 0.0f || W < 0.0f) && (U > 0.0f || V > 0.0f || W > 0.0f))
+		return false;
+
+	float det = U + V + W;
+	if (det == 0.0f)
+		return false;
+
+	float Az = wray.shear.z * A[wray.kz];
+	float Bz = wray.shear.z * B[wray.kz];
+	float Cz = wray.shear.z * C[wray.kz];
+	float inv_det = 1.0f / det;
+	float tt = (U * Az + V * Bz + W * Cz) * inv_det;
 
+	if (tt >= ray.tEnd || tt <= ray.tStart)
+		return false;
+
+	ray.tEnd = tt;
+	barycentric = glm::vec2(V * inv_det, W * inv_det);
+	return true;
+}
+
+BVHBuilder::BVHBuilder() : treeDepth(0), triangleIntersect(TriangleIntersect::Watertight) {}
+
+BVHBuilder::~BVHBuilder() {}
+
+void BVHBuilder::build(std::vector<float> const& vertexRaw)
+{
 	int floatInTriangle = 9; // x,y,z x,y,z x,y,z = 9 float
 	for (int index = 0; index < vertexRaw.size(); index += floatInTriangle)
 	{
@@ -157,8 +350,45 @@ void BVHBuilder::build(std::vector<float> const& vertexRaw)
 			vec3(vertexRaw[index + 6], vertexRaw[index + 7], vertexRaw[index + 8]),
 			index / floatInTriangle);
 	}
+	buildTree();
+}
+
+void BVHBuilder::build(IndexedMesh const& mesh)
+{
+	std::vector<float> const& position = mesh.getPosition();
+	std::vector<uint32_t> const& index = mesh.getIndex();
+	auto vertex = [&position](uint32_t vertexIndex) { return vec3(position[vertexIndex * 3], position[vertexIndex * 3 + 1], position[vertexIndex * 3 + 2]); };
+
+	vecTriangle.reserve(mesh.getTriangleCount());
+	for (size_t triangle = 0; triangle < mesh.getTriangleCount(); triangle++)
+		vecTriangle.emplace_back(vertex(index[triangle * 3]), vertex(index[triangle * 3 + 1]), vertex(index[triangle * 3 + 2]), (int)triangle);
+	buildTree();
+}
+
+void BVHBuilder::buildTree()
+{
+	nodeList.push_back(Node());
 	nodeList.reserve(vecTriangle.size());
-	buildRecurcive(0, vecTriangle);
+	std::vector<int> reference(vecTriangle.size());
+	for (int index = 0; index < (int)reference.size(); index++)
+		reference[index] = index;
+	buildRecurcive(0, reference.data(), reference.data() + reference.size());
+	precomputeTriangles();
+
+	// Depth bounds the traversal stack, ordered traversal never holds more than depth + 1 nodes
+	std::vector<std::pair<int, int>> depthStack{ {0, 1} };
+	while (!depthStack.empty())
+	{
+		auto [nodeIndex, depth] = depthStack.back();
+		depthStack.pop_back();
+		treeDepth = std::max(treeDepth, depth);
+
+		Node const& node = nodeList[nodeIndex];
+		if (((int)node.childIsTriangle & 1) == 0)
+			depthStack.emplace_back((int)node.leftChild, depth + 1);
+		if (((int)node.childIsTriangle & 2) == 0)
+			depthStack.emplace_back((int)node.rightChild, depth + 1);
+	}
 }
 
 void BVHBuilder::travel(glm::vec3& origin, glm::vec3& direction, glm::vec3& color, float& minT)
@@ -171,19 +401,217 @@ void BVHBuilder::travelCycle(glm::vec3& origin, glm::vec3& direction, glm::vec3&
 	travelStack(nodeList[0], origin, direction, color, minT);
 }
 
-Node *const BVHBuilder::bvhToTexture()
+int BVHBuilder::traceCloseHit(Ray& ray, Hit& hit) const
 {
-	int vertexCount = nodeList.size() * 3;
-	int sqrtVertCount = ceil(sqrt(vertexCount));
-	texSize = Utils::powerOfTwo(sqrtVertCount);
-	nodeList.resize(texSize * texSize);
+	int root = 0;
+	return traceCloseHit(ray, hit, &root, 1);
+}
 
-	return nodeList.data();
+int BVHBuilder::traceCloseHit(Ray& ray, Hit& hit, int const* startNodes, int startCount) const
+{
+	// Popped node push at most 2 children, so stack never hold more than tree depth + 1 nodes
+	int localStack[TraversalStackSize];
+	std::vector<int> heapStack;
+	int* stack = localStack;
+	if (treeDepth + 1 > TraversalStackSize)
+	{
+		heapStack.resize(treeDepth + 1);
+		stack = heapStack.data();
+	}
+	int stackSize = 0;
+	auto stackPush = [stack, &stackSize](int node)
+	{
+		stack[stackSize++] = node;
+	};
+
+	hit.isHit = false;
+	hit.triangleIndex = -1;
+	int visitCount = 0;
+	float tempt;
+	WatertightRay wray(ray.direction);
+
+	auto isectTri = [this, &ray, &hit, &wray](int index)
+	{
+		bool isHit = false;
+		vec3 const* triangle = &triangleData[index * 3];
+		if (triangleIntersect == TriangleIntersect::Watertight)
+			isHit = intersectWatertight(ray, wray, triangle, hit.barycentric);
+		else if (triangleIntersect == TriangleIntersect::Precomputed)
+			isHit = intersectPrecomputed(ray, triangle, hit.barycentric);
+		else
+			isHit = vecTriangle[index].rayIntersect(ray, hit.barycentric);
+
+		if (isHit)
+			hit.triangleIndex = index;
+	};
+
+	// Start nodes one by one near to far, far ones are culled by the shorter ray
+	for (int start = 0; start < startCount; start++)
+	{
+		stackPush(startNodes[start]);
+		while (stackSize != 0)
+		{
+			Node const& select = nodeList[stack[--stackSize]];
+			visitCount++;
+			if (!select.aabb.slabs(ray, tempt))
+				continue;
+
+			int childIsTriangle = (int)select.childIsTriangle;
+			int leftChild = (int)select.leftChild;
+			int rightChild = (int)select.rightChild;
+
+			if (childIsTriangle == 0)
+			{
+				float leftMinT = 0;
+				float rightMinT = 0;
+				bool rightI = nodeList[rightChild].aabb.slabs(ray, rightMinT);
+				bool leftI = nodeList[leftChild].aabb.slabs(ray, leftMinT);
+
+				// Push the far child first so the near one is popped next
+				if (rightI && leftI)
+				{
+					if (rightMinT < leftMinT)
+					{
+						stackPush(leftChild);
+						stackPush(rightChild);
+					}
+					else
+					{
+						stackPush(rightChild);
+						stackPush(leftChild);
+					}
+					continue;
+				}
+				if (rightI)
+					stackPush(rightChild);
+				if (leftI)
+					stackPush(leftChild);
+				continue;
+			}
+
+			if ((childIsTriangle & 2) == 0)
+				stackPush(rightChild);
+
+			if ((childIsTriangle & 1) == 0)
+				stackPush(leftChild);
+
+			if ((childIsTriangle & 2) > 0)
+				isectTri(rightChild);
+
+			if ((childIsTriangle & 1) > 0)
+				isectTri(leftChild);
+		}
+	}
+
+	if (hit.triangleIndex < 0)
+		return visitCount;
+
+	hit.distance = ray.tEnd;
+	hit.position = ray.origin + ray.direction * ray.tEnd;
+	hit.isHit = true;
+	return visitCount;
 }
 
-int BVHBuilder::getNodesSize()
+void BVHBuilder::collectFrustumNodes(Frustum const& frustum, std::vector<int>& nodes) const
 {
-	return texSize;
+	nodes.clear();
+	FrustumClass rootClass = nodeList[0].aabb.frustumTest(frustum);
+	if (rootClass == FrustumClass::Outside)
+		return;
+
+	// Breadth first: split nodes crossing the frustum into their visible children while budget allow
+	std::vector<std::pair<int, FrustumClass>> candidates{ {0, rootClass} };
+	for (size_t index = 0; index < candidates.size();)
+	{
+		auto [nodeIndex, nodeClass] = candidates[index];
+		Node const& node = nodeList[nodeIndex];
+		if (nodeClass == FrustumClass::Inside || (int)node.childIsTriangle != 0)
+		{
+			index++;
+			continue;
+		}
+
+		int leftChild = (int)node.leftChild;
+		int rightChild = (int)node.rightChild;
+		FrustumClass leftClass = nodeList[leftChild].aabb.frustumTest(frustum);
+		FrustumClass rightClass = nodeList[rightChild].aabb.frustumTest(frustum);
+		size_t visibleCount = (leftClass != FrustumClass::Outside) + (rightClass != FrustumClass::Outside);
+		if (candidates.size() - 1 + visibleCount > MaxFrustumNodes)
+		{
+			index++;
+			continue;
+		}
+
+		candidates.erase(candidates.begin() + index);
+		if (leftClass != FrustumClass::Outside)
+			candidates.emplace_back(leftChild, leftClass);
+		if (rightClass != FrustumClass::Outside)
+			candidates.emplace_back(rightChild, rightClass);
+	}
+
+	for (auto const& candidate : candidates)
+		nodes.push_back(candidate.first);
+
+	std::sort(nodes.begin(), nodes.end(), [this, &frustum](int left, int right)
+	{
+		return nodeList[left].aabb.distance(frustum.origin) < nodeList[right].aabb.distance(frustum.origin);
+	});
+}
+
+void BVHBuilder::getBounds(glm::vec3& min, glm::vec3& max) const
+{
+	min = nodeList[0].aabb.getMin();
+	max = nodeList[0].aabb.getMax();
+}
+
+void BVHBuilder::setTriangleIntersect(TriangleIntersect mode)
+{
+	triangleIntersect = mode;
+	precomputeTriangles();
+}
+
+void BVHBuilder::precomputeTriangles()
+{
+	triangleData.resize(vecTriangle.size() * 3);
+	for (size_t index = 0; index < vecTriangle.size(); index++)
+	{
+		Triangle const& tri = vecTriangle[index];
+		vec3* data = &triangleData[index * 3];
+		data[0] = tri.getVertex1();
+		data[1] = tri.getVertex2();
+		data[2] = tri.getVertex3();
+
+		if (triangleIntersect == TriangleIntersect::Precomputed)
+		{
+			data[1] = tri.getVertex2() - tri.getVertex1();
+			data[2] = tri.getVertex3() - tri.getVertex1();
+		}
+	}
+}
+
+// Texel 0: aabb min and left child, texel 1: aabb max and right child. Bit 31 of child marks triangle index
+void BVHBuilder::packNodes(std::vector<uint32_t>& texels) const
+{
+	texels.resize(nodeList.size() * 8);
+	for (size_t index = 0; index < nodeList.size(); index++)
+	{
+		Node const& node = nodeList[index];
+		uint32_t* texel = &texels[index * 8];
+		memcpy(texel, &node.aabb.getMin(), sizeof(vec3));
+		texel[3] = ((uint32_t)node.leftChild & 0x7FFFFFFFu) | ((uint32_t)node.childIsTriangle & 1u) << 31;
+		memcpy(texel + 4, &node.aabb.getMax(), sizeof(vec3));
+		texel[7] = ((uint32_t)node.rightChild & 0x7FFFFFFFu) | ((uint32_t)node.childIsTriangle & 2u) << 30;
+	}
+}
+
+int BVHBuilder::getNodeCount() const
+{
+	return nodeList.size();
+}
+
+int BVHBuilder::getTreeDepth() const
+{
+	return treeDepth;
 }
 
 std::vector<Node> BVHBuilder::getNodes()
@@ -193,38 +621,39 @@ std::vector<Node> BVHBuilder::getNodes()
 
 
 
-void BVHBuilder::buildRecurcive(int nodeIndex, std::vector<Triangle> const& vecTriangle)
+void BVHBuilder::buildRecurcive(int nodeIndex, int* begin, int* end)
 {
-	//Build Bpun box for triangles in vecTriangle
-	AABB tempaabb = vecTriangle[0].getAABB();
-	for (Triangle const& tri : vecTriangle)
-		tempaabb.surrounding(tri.getAABB());
+	//Build Bpun box for triangles in [begin, end)
+	AABB tempaabb = vecTriangle[*begin].getAABB();
+	for (int* tri = begin; tri != end; tri++)
+		tempaabb.surrounding(vecTriangle[*tri].getAABB());
 
 	Node& node = nodeList[nodeIndex];
 	node.aabb = tempaabb;
 
-	if (vecTriangle.size() == 2)
+	if (end - begin == 2)
 	{
 		/*node.rightChildIsTriangle = true;
 		node.leftChildIsTriangle = true;*/
 		node.childIsTriangle = 3;
-		node.leftChild = vecTriangle[0].getIndex();
-		node.rightChild = vecTriangle[1].getIndex();
+		node.leftChild = vecTriangle[begin[0]].getIndex();
+		node.rightChild = vecTriangle[begin[1]].getIndex();
 		return;
 	}
 
 	// seach max dimenson for split 
-	vec3 maxVec = vecTriangle[0].getCenter();
-	vec3 minVec = vecTriangle[0].getCenter();
+	vec3 maxVec = vecTriangle[*begin].getCenter();
+	vec3 minVec = vecTriangle[*begin].getCenter();
 	vec3 centerSum(0, 0, 0);
 
-	for (Triangle const& tri : vecTriangle)
+	for (int* ref = begin; ref != end; ref++)
 	{
+		Triangle const& tri = vecTriangle[*ref];
 		maxVec = glm::max(tri.getCenter(), maxVec);
 		minVec = glm::min(tri.getCenter(), minVec);
 		centerSum += tri.getCenter();
 	}
-	vec3 midPoint = centerSum / (float)vecTriangle.size();
+	vec3 midPoint = centerSum / (float)(end - begin);
 	vec3 len = glm::abs(maxVec - minVec);
 
 	int axis = 0;
@@ -235,20 +664,16 @@ void BVHBuilder::buildRecurcive(int nodeIndex, std::vector<Triangle> const& vecT
 	if (len.z > len.y&& len.z > len.x)
 		axis = 2;
 
-	std::vector<Triangle> tempLeftTriangleList;
-	std::vector<Triangle> tempRightTriangleList;
-
-	auto splitByAxis = [&tempLeftTriangleList, &tempRightTriangleList, &midPoint, &vecTriangle](std::function<float(vec3 const& point)> getElement)
+	// Stable partition of references keeps order of old copied lists, so tree is the same without copies
+	int* middle = begin;
+	auto splitByAxis = [this, &middle, &midPoint, begin, end](std::function<float(vec3 const& point)> getElement)
 	{
-		for (Triangle const& tri : vecTriangle)
+		middle = std::stable_partition(begin, end, [this, &midPoint, &getElement](int tri)
 		{
-			if (getElement(tri.getCenter()) < getElement(midPoint))
-				tempLeftTriangleList.push_back(tri);
-			else
-				tempRightTriangleList.push_back(tri);
-		}
-		assert(tempLeftTriangleList.size());
-		assert(tempRightTriangleList.size());
+			return getElement(vecTriangle[tri].getCenter()) < getElement(midPoint);
+		});
+		assert(middle != begin);
+		assert(middle != end);
 	};
 
 	using namespace std::placeholders;
@@ -262,9 +687,9 @@ void BVHBuilder::buildRecurcive(int nodeIndex, std::vector<Triangle> const& vecT
 	if (axis == 2)
 		splitByAxis(bind(&vec3::z, _1));
 
-	if (tempLeftTriangleList.size() == 1)
+	if (middle - begin == 1)
 	{
-		node.leftChild = tempLeftTriangleList[0].getIndex();
+		node.leftChild = vecTriangle[*begin].getIndex();
 		node.childIsTriangle = 1;
 		//node.leftChildIsTriangle = true;
 	}
@@ -272,12 +697,12 @@ void BVHBuilder::buildRecurcive(int nodeIndex, std::vector<Triangle> const& vecT
 	{
 		node.leftChild = nodeList.size();
 		nodeList.emplace_back();
-		buildRecurcive(nodeList.size() - 1, tempLeftTriangleList);
+		buildRecurcive(nodeList.size() - 1, begin, middle);
 	}
 
-	if (tempRightTriangleList.size() == 1)
+	if (end - middle == 1)
 	{
-		node.rightChild = tempRightTriangleList[0].getIndex();
+		node.rightChild = vecTriangle[*middle].getIndex();
 		node.childIsTriangle = 2;
 		//node.rightChildIsTriangle = true;
 	}
@@ -285,7 +710,7 @@ void BVHBuilder::buildRecurcive(int nodeIndex, std::vector<Triangle> const& vecT
 	{
 		node.rightChild = nodeList.size();
 		nodeList.emplace_back();
-		buildRecurcive(nodeList.size() - 1, tempRightTriangleList);
+		buildRecurcive(nodeList.size() - 1, middle, end);
 	}
 }
 
@@ -0,0 +1,150 @@
+#include <glm.hpp>
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX // std::max below, not the windows.h macro
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <random>
+#include <vector>
+#include "Benchmark.h"
+#include "BVHBuilder.h"
+#include "ThreadPool.h"
+#include "RayStream.h"
+#include "Ray.h"
+#include "ModelLoader.h"
+#include "MappedFile.h"
+#include "Utils.h"
+#include "MeshAttributes.h"
+
+using glm::vec3;
+
+namespace
+{
+	// Mean of repeatCount runs, at least one run
+	template<typename Function>
+	double measureSeconds(int repeatCount, Function function)
+	{
+		repeatCount = std::max(repeatCount, 1);
+		auto start = std::chrono::steady_clock::now();
+		for (int repeat = 0; repeat < repeatCount; repeat++)
+			function();
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		return elapsed.count() / repeatCount;
+	}
+}
+
+void Benchmark::rayStream(BVHBuilder const& bvh, MeshAttributes const& attributes, ThreadPool& pool, glm::vec3 const& location, int rayCount, int repeatCount)
+{
+	std::mt19937 random(1234);
+	std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+	std::normal_distribution<float> normal(0.0f, 1.0f);
+
+	// Secondary rays: primary ray from camera inside 90 degree cone, random direction from hit point.
+	// Attempts are limited, model may be outside of the cone
+	std::vector<Ray> rays;
+	rays.reserve(rayCount);
+	int64_t maxAttempts = 10 * (int64_t)rayCount;
+	for (int64_t attempt = 0; attempt < maxAttempts && (int)rays.size() < rayCount; attempt++)
+	{
+		Ray primary;
+		primary.origin = location;
+		primary.direction = glm::normalize(vec3(unit(random) - 0.5f, unit(random) - 0.5f, 1.0f));
+		primary.tStart = 0.0001f;
+		primary.tEnd = 10000.0f;
+
+		Hit hit;
+		bvh.traceCloseHit(primary, hit);
+		if (!hit.isHit)
+			continue;
+
+		vec3 faceNormal = attributes.getFaceNormal(hit.triangleIndex);
+		vec3 surfaceNormal = glm::dot(faceNormal, primary.direction) > 0.0f ? -faceNormal : faceNormal;
+		Ray ray;
+		ray.direction = glm::normalize(vec3(normal(random), normal(random), normal(random)));
+		ray.origin = hit.position + surfaceNormal * 1e-3f;
+		ray.tStart = 0.0001f;
+		ray.tEnd = 10000.0f;
+		rays.push_back(ray);
+	}
+
+	if ((int)rays.size() < rayCount)
+	{
+		std::cerr << "Only " << rays.size() << " of " << maxAttempts << " camera rays hit the model, asked for " << rayCount << std::endl;
+		if (rays.empty())
+			return;
+		rayCount = (int)rays.size();
+	}
+
+	std::vector<Hit> hits;
+	std::vector<Hit> sortedHits;
+	std::vector<uint32_t> order;
+	vec3 boundsMin, boundsMax;
+	bvh.getBounds(boundsMin, boundsMax);
+
+	RayStream::traceCloseHit(bvh, pool, rays, hits, false); // warm up
+	double unsortedTime = measureSeconds(repeatCount, [&] { RayStream::traceCloseHit(bvh, pool, rays, hits, false); });
+	double sortTime = measureSeconds(repeatCount, [&] { RayStream::sortOrder(rays, boundsMin, boundsMax, order); });
+	double sortedTime = measureSeconds(repeatCount, [&] { RayStream::traceCloseHit(bvh, pool, rays, sortedHits, true); });
+
+	int mismatch = 0;
+	for (size_t index = 0; index < hits.size(); index++)
+		mismatch += hits[index].triangleIndex != sortedHits[index].triangleIndex;
+
+	double megaRays = rayCount / 1e6;
+	std::cout << "Ray stream, " << rayCount << " random direction rays, " << pool.getThreadCount() << " threads" << std::endl;
+	std::cout << "Unsorted " << unsortedTime * 1000.0 << " ms, " << megaRays / unsortedTime << " Mrays/s" << std::endl;
+	std::cout << "Sorted   " << sortedTime * 1000.0 << " ms, " << megaRays / sortedTime << " Mrays/s (sort " << sortTime * 1000.0 << " ms included)" << std::endl;
+	if (mismatch)
+		std::cerr << "Sorted and unsorted results differ for " << mismatch << " rays" << std::endl;
+}
+
+void Benchmark::objLoader(ThreadPool& pool, std::string const& filePath, int repeatCount)
+{
+	size_t fileSize = MappedFile(Utils::resourceDir + filePath).size();
+	std::vector<float> vertex, normal, uv;
+	std::vector<float> mappedVertex, mappedNormal, mappedUV;
+	std::vector<float> parallelVertex, parallelNormal, parallelUV;
+
+	double objTime = measureSeconds(repeatCount, [&] { ModelLoader::Obj(filePath, vertex, normal, uv); });
+	double mappedTime = measureSeconds(repeatCount, [&] { ModelLoader::ObjMapped(filePath, mappedVertex, mappedNormal, mappedUV); });
+	double parallelTime = measureSeconds(repeatCount, [&] { ModelLoader::ObjMapped(filePath, parallelVertex, parallelNormal, parallelUV, &pool); });
+
+	double megaBytes = fileSize / (1024.0 * 1024.0);
+	std::cout << "OBJ " << filePath << ", " << megaBytes << " MB, " << vertex.size() / 9 << " triangles" << std::endl;
+	std::cout << "Obj       " << objTime * 1000.0 << " ms, " << megaBytes / objTime << " MB/s" << std::endl;
+	std::cout << "ObjMapped " << mappedTime * 1000.0 << " ms, " << megaBytes / mappedTime << " MB/s" << std::endl;
+	std::cout << "ObjMapped " << pool.getThreadCount() << " threads " << parallelTime * 1000.0 << " ms, " << megaBytes / parallelTime << " MB/s" << std::endl;
+	if (vertex != mappedVertex || normal != mappedNormal || uv != mappedUV)
+		std::cerr << "ObjMapped output differ from Obj" << std::endl;
+	if (vertex != parallelVertex || normal != parallelNormal || uv != parallelUV)
+		std::cerr << "ObjMapped on pool output differ from Obj" << std::endl;
+}
+
+double Benchmark::peakMemoryMB()
+{
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters)))
+		return 0.0;
+	return counters.PeakWorkingSetSize / (1024.0 * 1024.0);
+#else
+	rusage usage;
+	if (getrusage(RUSAGE_SELF, &usage) != 0)
+		return 0.0;
+#ifdef __APPLE__
+	return usage.ru_maxrss / (1024.0 * 1024.0); // bytes
+#else
+	return usage.ru_maxrss / 1024.0; // kilobytes
+#endif
+#endif
+}
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <atomic>
+#include "CpuRenderer.h"
+#include "BVHBuilder.h"
+#include "MeshAttributes.h"
+#include "ThreadPool.h"
+#include "Ray.h"
+
+using glm::vec2;
+using glm::vec3;
+
+CpuRenderer::CpuRenderer(BVHBuilder const& bvh, MeshAttributes const& attributes, int width, int height, int tileSize) :
+	bvh(bvh),
+	attributes(attributes),
+	width(width),
+	height(height),
+	tileSize(tileSize),
+	tileCountX((width + tileSize - 1) / tileSize),
+	tileCountY((height + tileSize - 1) / tileSize),
+	frustumCulling(false),
+	nodeVisitCount(0),
+	image((size_t)width * height * 3, 0) {}
+
+void CpuRenderer::render(ThreadPool& pool, glm::vec3 const& location, glm::mat3 const& viewToWorld)
+{
+	std::atomic<int64_t> visitCount(0);
+	pool.parallelFor(tileCountX * tileCountY, [this, &location, &viewToWorld, &visitCount](int tileIndex)
+	{
+		visitCount += renderTile(tileIndex, location, viewToWorld);
+	});
+	nodeVisitCount = visitCount;
+}
+
+void CpuRenderer::setFrustumCulling(bool enable)
+{
+	frustumCulling = enable;
+}
+
+std::vector<uint8_t> const& CpuRenderer::getImage() const
+{
+	return image;
+}
+
+double CpuRenderer::getNodeVisitsPerRay() const
+{
+	return (double)nodeVisitCount / ((double)width * height);
+}
+
+int CpuRenderer::getWidth() const
+{
+	return width;
+}
+
+int CpuRenderer::getHeight() const
+{
+	return height;
+}
+
+glm::vec3 CpuRenderer::viewDirection(glm::vec2 const& fragCoord, glm::mat3 const& viewToWorld) const
+{
+	vec2 screeResolution(width, height);
+	vec3 viewDir = glm::normalize(vec3((fragCoord - screeResolution * 0.5f) / screeResolution.y, 1.0f));
+	return viewToWorld * viewDir;
+}
+
+int64_t CpuRenderer::renderTile(int tileIndex, glm::vec3 const& location, glm::mat3 const& viewToWorld)
+{
+	int startX = (tileIndex % tileCountX) * tileSize;
+	int startY = (tileIndex / tileCountX) * tileSize;
+	int endX = std::min(startX + tileSize, width);
+	int endY = std::min(startY + tileSize, height);
+
+	// gl_FragCoord is pixel center with origin in bottom left corner, tile frustum goes through pixel borders
+	std::vector<int> startNodes{ 0 };
+	if (frustumCulling)
+	{
+		vec3 corner[4] = {
+			viewDirection(vec2(startX, height - endY), viewToWorld),
+			viewDirection(vec2(endX, height - endY), viewToWorld),
+			viewDirection(vec2(endX, height - startY), viewToWorld),
+			viewDirection(vec2(startX, height - startY), viewToWorld) };
+
+		vec3 center = corner[0] + corner[1] + corner[2] + corner[3];
+
+		Frustum frustum;
+		frustum.origin = location;
+		for (int side = 0; side < 4; side++)
+		{
+			vec3 normal = glm::cross(corner[side], corner[(side + 1) % 4]);
+			frustum.normals[side] = glm::dot(normal, center) < 0.0f ? -normal : normal;
+		}
+
+		bvh.collectFrustumNodes(frustum, startNodes);
+	}
+
+	int64_t visitCount = 0;
+	for (int y = startY; y < endY; y++)
+	{
+		for (int x = startX; x < endX; x++)
+		{
+			Ray ray;
+			ray.direction = viewDirection(vec2(x + 0.5f, height - y - 0.5f), viewToWorld);
+			ray.origin = location;
+			ray.tStart = 0.0001f;
+			ray.tEnd = 10000.0f;
+
+			Hit hit;
+			hit.normal = vec3(0.0f);
+			visitCount += bvh.traceCloseHit(ray, hit, startNodes.data(), (int)startNodes.size());
+			attributes.resolve(hit);
+
+			vec3 color = glm::clamp(0.5f + hit.normal * 0.5f, 0.0f, 1.0f);
+			uint8_t* pixel = &image[((size_t)y * width + x) * 3];
+			pixel[0] = (uint8_t)(color.x * 255.0f + 0.5f);
+			pixel[1] = (uint8_t)(color.y * 255.0f + 0.5f);
+			pixel[2] = (uint8_t)(color.z * 255.0f + 0.5f);
+		}
+	}
+	return visitCount;
+}
@@ -0,0 +1,244 @@
+#include "DecompressStream.h"
+#include <iostream>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace
+{
+	constexpr size_t InputSize = 1024 * 1024;
+
+	bool hasExtension(std::string const& filePath, char const* extension)
+	{
+		std::string end(extension);
+		return filePath.size() >= end.size() && filePath.compare(filePath.size() - end.size(), end.size(), end) == 0;
+	}
+}
+
+DecompressStream::DecompressStream(std::string const& filePath) : codec(Codec::Gzip), isOpenFile(false), isFinished(false), isBroken(false), stop(false)
+{
+	codec = hasExtension(filePath, ".zst") ? Codec::Zstd : Codec::Gzip;
+#ifndef HAVE_ZLIB
+	if (codec == Codec::Gzip)
+	{
+		std::cerr << filePath << ": built without zlib, gzip input is not supported" << std::endl;
+		return;
+	}
+#endif
+#ifndef HAVE_ZSTD
+	if (codec == Codec::Zstd)
+	{
+		std::cerr << filePath << ": built without zstd, zstd input is not supported" << std::endl;
+		return;
+	}
+#endif
+
+	std::FILE* file = std::fopen(filePath.c_str(), "rb");
+	if (!file)
+		return;
+	isOpenFile = true;
+	worker = std::thread(&DecompressStream::decompressLoop, this, file, filePath);
+}
+
+DecompressStream::~DecompressStream()
+{
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		stop = true;
+	}
+	condition.notify_all();
+
+	if (worker.joinable())
+		worker.join();
+}
+
+bool DecompressStream::isCompressed(std::string const& filePath)
+{
+	return hasExtension(filePath, ".gz") || hasExtension(filePath, ".zst");
+}
+
+std::string DecompressStream::withoutCompression(std::string const& filePath)
+{
+	if (hasExtension(filePath, ".gz"))
+		return filePath.substr(0, filePath.size() - 3);
+	if (hasExtension(filePath, ".zst"))
+		return filePath.substr(0, filePath.size() - 4);
+	return filePath;
+}
+
+bool DecompressStream::isOpen() const
+{
+	return isOpenFile;
+}
+
+bool DecompressStream::read(std::vector<char>& block)
+{
+	if (!isOpenFile)
+		return false;
+
+	std::unique_lock<std::mutex> lock(mutex);
+	condition.wait(lock, [this] { return !blocks.empty() || isFinished; });
+	if (blocks.empty())
+		return false;
+
+	block = std::move(blocks.front());
+	blocks.pop_front();
+	condition.notify_all();
+	return true;
+}
+
+bool DecompressStream::isGood() const
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return !isBroken;
+}
+
+void DecompressStream::decompressLoop(std::FILE* file, std::string filePath)
+{
+	bool isGood = codec == Codec::Gzip ? inflateFile(file) : zstdFile(file);
+	std::fclose(file);
+	if (!isGood)
+		std::cerr << filePath << ": broken or truncated compressed data" << std::endl;
+
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		isFinished = true;
+		isBroken = !isGood;
+	}
+	condition.notify_all();
+}
+
+bool DecompressStream::pushBlock(std::vector<char>& block)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	condition.wait(lock, [this] { return stop || blocks.size() < MaxQueuedBlocks; });
+	if (stop)
+		return false;
+
+	blocks.push_back(std::move(block));
+	condition.notify_all();
+	return true;
+}
+
+// Input is read only when codec has no pending output, otherwise last bytes of full block would be lost at file end
+bool DecompressStream::inflateFile([[maybe_unused]] std::FILE* file)
+{
+#ifdef HAVE_ZLIB
+	z_stream stream = {};
+	if (inflateInit2(&stream, 15 + 32) != Z_OK) // 32: detect gzip or zlib header
+		return false;
+
+	std::vector<char> input(InputSize);
+	std::vector<char> block(BlockSize);
+	size_t filled = 0;
+	int result = Z_OK;
+	bool hasOutputSpace = true;
+	bool isGood = true;
+
+	while (true)
+	{
+		if (stream.avail_in == 0 && (hasOutputSpace || result == Z_STREAM_END))
+		{
+			stream.next_in = (Bytef*)input.data();
+			stream.avail_in = (uInt)std::fread(input.data(), 1, input.size(), file);
+			if (stream.avail_in == 0)
+			{
+				isGood = result == Z_STREAM_END;
+				break;
+			}
+		}
+		if (result == Z_STREAM_END)
+			inflateReset(&stream); // next member of concatenated gzip
+
+		stream.next_out = (Bytef*)block.data() + filled;
+		stream.avail_out = (uInt)(block.size() - filled);
+		result = inflate(&stream, Z_NO_FLUSH);
+		if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR)
+		{
+			isGood = false;
+			break;
+		}
+
+		filled = block.size() - stream.avail_out;
+		hasOutputSpace = stream.avail_out != 0;
+		if (filled == block.size())
+		{
+			if (!pushBlock(block))
+				break;
+			block = std::vector<char>(BlockSize);
+			filled = 0;
+		}
+	}
+	inflateEnd(&stream);
+
+	block.resize(filled);
+	if (!block.empty())
+		pushBlock(block);
+	return isGood;
+#else
+	return false;
+#endif
+}
+
+bool DecompressStream::zstdFile([[maybe_unused]] std::FILE* file)
+{
+#ifdef HAVE_ZSTD
+	ZSTD_DStream* stream = ZSTD_createDStream();
+	if (!stream || ZSTD_isError(ZSTD_initDStream(stream)))
+	{
+		ZSTD_freeDStream(stream);
+		return false;
+	}
+
+	std::vector<char> input(ZSTD_DStreamInSize());
+	std::vector<char> block(BlockSize);
+	ZSTD_inBuffer in = { input.data(), 0, 0 };
+	size_t filled = 0;
+	size_t result = 0; // 0 when frame is complete
+	bool hasOutputSpace = true;
+	bool isGood = true;
+
+	while (true)
+	{
+		if (in.pos == in.size && hasOutputSpace)
+		{
+			in.size = std::fread(input.data(), 1, input.size(), file);
+			in.pos = 0;
+			if (in.size == 0)
+			{
+				isGood = result == 0;
+				break;
+			}
+		}
+
+		ZSTD_outBuffer out = { block.data(), block.size(), filled };
+		result = ZSTD_decompressStream(stream, &out, &in);
+		if (ZSTD_isError(result))
+		{
+			isGood = false;
+			break;
+		}
+
+		filled = out.pos;
+		hasOutputSpace = out.pos != out.size;
+		if (filled == block.size())
+		{
+			if (!pushBlock(block))
+				break;
+			block = std::vector<char>(BlockSize);
+			filled = 0;
+		}
+	}
+	ZSTD_freeDStream(stream);
+
+	block.resize(filled);
+	if (!block.empty())
+		pushBlock(block);
+	return isGood;
+#else
+	return false;
+#endif
+}
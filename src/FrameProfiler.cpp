@@ -0,0 +1,212 @@
+#include "FrameProfiler.h"
+#include "glad.h" // Opengl function loader
+#include <algorithm>
+#include <iostream>
+#include <iomanip>
+#include <cmath>
+
+namespace
+{
+	constexpr int FrameMetric = 0;
+	constexpr int GpuFrameMetric = 1;
+
+	double elapsedMilliseconds(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+}
+
+FrameProfiler::Scope::Scope(FrameProfiler& profiler, int section) : profiler(profiler), section(section), start(std::chrono::steady_clock::now()) {}
+
+FrameProfiler::Scope::~Scope()
+{
+	profiler.addTime(section, elapsedMilliseconds(start));
+}
+
+FrameProfiler::FrameProfiler(std::vector<std::string> const& cpuSections, std::vector<std::string> const& gpuPasses, int reportFrames, std::string const& csvPath) :
+	frameNumber(0), resolvedFrame(0), droppedFrames(0), lastTimestamp(0), lastTimestampFrame(-1), reportFrames(std::max(reportFrames, 1)), framesSinceReport(0)
+{
+	metricNames = { "frame", "gpu frame" };
+	gpuOffset = (int)metricNames.size();
+	metricNames.insert(metricNames.end(), gpuPasses.begin(), gpuPasses.end());
+	cpuOffset = (int)metricNames.size();
+	metricNames.insert(metricNames.end(), cpuSections.begin(), cpuSections.end());
+	samples.resize(metricNames.size());
+	latestPassTimes.assign(gpuPasses.size(), NAN);
+
+	ring.resize(RingSize);
+	for (Frame& frame : ring)
+	{
+		glGenQueries(1, &frame.timestampQuery);
+		frame.passQueries.resize(gpuPasses.size());
+		glGenQueries((int)gpuPasses.size(), frame.passQueries.data());
+		frame.isPassUsed.assign(gpuPasses.size(), false);
+		frame.cpuTimes.assign(cpuSections.size(), 0.0);
+		frame.frameTime = 0.0;
+	}
+
+	if (csvPath.empty())
+		return;
+	csv.open(csvPath);
+	if (!csv)
+	{
+		std::cerr << "error open profile file " << csvPath << std::endl;
+		return;
+	}
+	csv << "frame";
+	for (std::string const& name : metricNames)
+	{
+		std::string column = name;
+		std::replace(column.begin(), column.end(), ' ', '_');
+		csv << "," << column << "_ms";
+	}
+	csv << "\n";
+}
+
+FrameProfiler::~FrameProfiler()
+{
+	for (Frame& frame : ring)
+	{
+		glDeleteQueries(1, &frame.timestampQuery);
+		glDeleteQueries((int)frame.passQueries.size(), frame.passQueries.data());
+	}
+}
+
+void FrameProfiler::beginFrame()
+{
+	// Slot of frame RingSize ago is reused, its result is lost if GPU is still behind
+	if (frameNumber - resolvedFrame >= RingSize)
+	{
+		resolvedFrame++;
+		droppedFrames++;
+	}
+
+	Frame& frame = ring[frameNumber % RingSize];
+	std::fill(frame.isPassUsed.begin(), frame.isPassUsed.end(), false);
+	std::fill(frame.cpuTimes.begin(), frame.cpuTimes.end(), 0.0);
+	glQueryCounter(frame.timestampQuery, GL_TIMESTAMP);
+	frameStart = std::chrono::steady_clock::now();
+}
+
+void FrameProfiler::endFrame()
+{
+	ring[frameNumber % RingSize].frameTime = elapsedMilliseconds(frameStart);
+	frameNumber++;
+
+	while (resolvedFrame < frameNumber && isAvailable(ring[resolvedFrame % RingSize]))
+	{
+		resolve(ring[resolvedFrame % RingSize], resolvedFrame);
+		resolvedFrame++;
+	}
+}
+
+void FrameProfiler::beginPass(int pass)
+{
+	Frame& frame = ring[frameNumber % RingSize];
+	frame.isPassUsed[pass] = true;
+	glBeginQuery(GL_TIME_ELAPSED, frame.passQueries[pass]);
+}
+
+void FrameProfiler::endPass()
+{
+	glEndQuery(GL_TIME_ELAPSED);
+}
+
+void FrameProfiler::addTime(int section, double milliseconds)
+{
+	ring[frameNumber % RingSize].cpuTimes[section] += milliseconds;
+}
+
+double FrameProfiler::takePassTime(int pass)
+{
+	double milliseconds = latestPassTimes[pass];
+	latestPassTimes[pass] = NAN;
+	return milliseconds;
+}
+
+bool FrameProfiler::isAvailable(Frame const& frame) const
+{
+	GLint isReady = 0;
+	glGetQueryObjectiv(frame.timestampQuery, GL_QUERY_RESULT_AVAILABLE, &isReady);
+	for (size_t pass = 0; pass < frame.passQueries.size() && isReady; pass++)
+		if (frame.isPassUsed[pass])
+			glGetQueryObjectiv(frame.passQueries[pass], GL_QUERY_RESULT_AVAILABLE, &isReady);
+	return isReady != 0;
+}
+
+// Missing value (pass not drawn, no previous timestamp) is NaN, it is skipped by statistics and empty in CSV
+void FrameProfiler::resolve(Frame const& frame, int64_t number)
+{
+	std::vector<double> values(metricNames.size(), NAN);
+	values[FrameMetric] = frame.frameTime;
+
+	GLuint64 timestamp = 0;
+	glGetQueryObjectui64v(frame.timestampQuery, GL_QUERY_RESULT, &timestamp);
+	if (number > 0 && lastTimestampFrame == number - 1)
+		values[GpuFrameMetric] = (timestamp - lastTimestamp) / 1e6;
+	lastTimestamp = timestamp;
+	lastTimestampFrame = number;
+
+	for (size_t pass = 0; pass < frame.passQueries.size(); pass++)
+	{
+		if (!frame.isPassUsed[pass])
+			continue;
+		GLuint64 elapsed = 0;
+		glGetQueryObjectui64v(frame.passQueries[pass], GL_QUERY_RESULT, &elapsed);
+		values[gpuOffset + pass] = elapsed / 1e6;
+		latestPassTimes[pass] = elapsed / 1e6;
+	}
+	for (size_t section = 0; section < frame.cpuTimes.size(); section++)
+		values[cpuOffset + section] = frame.cpuTimes[section];
+
+	for (int metric = 0; metric < (int)values.size(); metric++)
+		addSample(metric, values[metric]);
+
+	if (csv.is_open())
+	{
+		csv << number;
+		for (double value : values)
+		{
+			csv << ",";
+			if (!std::isnan(value))
+				csv << value;
+		}
+		csv << "\n";
+	}
+
+	if (++framesSinceReport == reportFrames)
+	{
+		report();
+		framesSinceReport = 0;
+	}
+}
+
+void FrameProfiler::addSample(int metric, double milliseconds)
+{
+	if (std::isnan(milliseconds))
+		return;
+	std::deque<double>& window = samples[metric];
+	window.push_back(milliseconds);
+	if ((int)window.size() > reportFrames)
+		window.pop_front();
+}
+
+// p99 is nearest rank of window, with 100 frames it is the second slowest
+void FrameProfiler::report()
+{
+	std::streamsize precision = std::cout.precision();
+	std::cout << std::fixed << std::setprecision(2) << "Frame ms min/avg/p99:";
+	for (size_t metric = 0; metric < metricNames.size(); metric++)
+	{
+		std::vector<double> sorted(samples[metric].begin(), samples[metric].end());
+		if (sorted.empty())
+			continue;
+		std::sort(sorted.begin(), sorted.end());
+		double sum = 0.0;
+		for (double value : sorted)
+			sum += value;
+		size_t rank = (size_t)std::ceil(0.99 * sorted.size()) - 1;
+		std::cout << " " << metricNames[metric] << " " << sorted.front() << "/" << sum / sorted.size() << "/" << sorted[rank] << ",";
+	}
+	std::cout << " dropped " << droppedFrames << std::defaultfloat << std::setprecision(precision) << std::endl;
+}
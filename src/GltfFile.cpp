@@ -0,0 +1,167 @@
+#include "GltfFile.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace
+{
+	constexpr uint32_t GlbMagic = 0x46546C67;     // "glTF"
+	constexpr uint32_t GlbChunkJson = 0x4E4F534A; // "JSON"
+	constexpr uint32_t GlbChunkBin = 0x004E4942;  // "BIN\0"
+
+	uint32_t readUint32(char const* data)
+	{
+		uint32_t value;
+		memcpy(&value, data, sizeof(value)); // GLB is little endian as every target platform
+		return value;
+	}
+
+	size_t componentSize(int componentType)
+	{
+		switch (componentType)
+		{
+		case 5120: case 5121: return 1;
+		case 5122: case 5123: return 2;
+		case 5125: case 5126: return 4;
+		default: return 0;
+		}
+	}
+
+	int componentCount(std::string const& type)
+	{
+		if (type == "SCALAR") return 1;
+		if (type == "VEC2") return 2;
+		if (type == "VEC3") return 3;
+		if (type == "VEC4") return 4;
+		return 0; // matrices are not vertex data
+	}
+
+	template<typename T>
+	T readComponent(char const* data)
+	{
+		T value;
+		memcpy(&value, data, sizeof(T));
+		return value;
+	}
+}
+
+bool GltfAccessor::isValid() const
+{
+	return data != nullptr;
+}
+
+float GltfAccessor::getFloat(size_t element, int component) const
+{
+	char const* value = data + element * stride + component * componentSize(componentType);
+	switch (componentType)
+	{
+	case 5120: return normalized ? std::max(readComponent<int8_t>(value) / 127.0f, -1.0f) : readComponent<int8_t>(value);
+	case 5121: return normalized ? readComponent<uint8_t>(value) / 255.0f : readComponent<uint8_t>(value);
+	case 5122: return normalized ? std::max(readComponent<int16_t>(value) / 32767.0f, -1.0f) : readComponent<int16_t>(value);
+	case 5123: return normalized ? readComponent<uint16_t>(value) / 65535.0f : readComponent<uint16_t>(value);
+	case 5125: return (float)readComponent<uint32_t>(value);
+	case 5126: return readComponent<float>(value);
+	default: return 0.0f;
+	}
+}
+
+uint32_t GltfAccessor::getIndex(size_t element) const
+{
+	char const* value = data + element * stride;
+	switch (componentType)
+	{
+	case 5121: return readComponent<uint8_t>(value);
+	case 5123: return readComponent<uint16_t>(value);
+	case 5125: return readComponent<uint32_t>(value);
+	default: return 0;
+	}
+}
+
+GltfFile::GltfFile(std::string const& filePath) : file(filePath), binary(nullptr), binarySize(0), isGood(false)
+{
+	if (!file.isOpen())
+	{
+		std::cerr << "error load file " + filePath << std::endl;
+		return;
+	}
+
+	char const* data = file.data();
+	size_t size = file.size();
+	if (size < 20 || readUint32(data) != GlbMagic || readUint32(data + 4) != 2)
+	{
+		std::cerr << filePath << ": not binary glTF 2.0" << std::endl;
+		return;
+	}
+
+	size = std::min<size_t>(size, readUint32(data + 8));
+	size_t offset = 12;
+	while (offset + 8 <= size)
+	{
+		size_t chunkSize = readUint32(data + offset);
+		uint32_t chunkType = readUint32(data + offset + 4);
+		char const* chunk = data + offset + 8;
+		if (chunkSize > size - offset - 8)
+			break;
+
+		if (chunkType == GlbChunkJson && json.isNull() && !JsonValue::parse(chunk, chunk + chunkSize, json))
+		{
+			std::cerr << filePath << ": broken JSON chunk" << std::endl;
+			return;
+		}
+		if (chunkType == GlbChunkBin && !binary)
+		{
+			binary = chunk;
+			binarySize = chunkSize;
+		}
+		offset += 8 + ((chunkSize + 3) & ~size_t(3));
+	}
+
+	isGood = json.getType() == JsonValue::Type::Object;
+	if (!isGood)
+		std::cerr << filePath << ": no JSON chunk" << std::endl;
+}
+
+bool GltfFile::isOpen() const
+{
+	return isGood;
+}
+
+JsonValue const& GltfFile::getJson() const
+{
+	return json;
+}
+
+GltfAccessor GltfFile::getAccessor(int index) const
+{
+	GltfAccessor view;
+	JsonValue const& accessor = json["accessors"][index];
+	JsonValue const& bufferView = json["bufferViews"][accessor["bufferView"].getInt(-1)];
+	JsonValue const& buffer = json["buffers"][bufferView["buffer"].getInt(-1)];
+
+	// Only data of GLB binary chunk: buffer 0 without uri, no sparse accessors
+	if (bufferView.isNull() || bufferView["buffer"].getInt() != 0 || buffer.has("uri") || accessor.has("sparse") || !binary)
+		return view;
+
+	auto getSize = [](JsonValue const& value, double defaultValue) { return (size_t)std::max(value.getNumber(defaultValue), 0.0); };
+	int type = accessor["componentType"].getInt();
+	int count = componentCount(accessor["type"].getString());
+	size_t elementSize = componentSize(type) * count;
+	size_t viewOffset = getSize(bufferView["byteOffset"], 0.0);
+	size_t viewLength = getSize(bufferView["byteLength"], 0.0);
+	size_t offset = getSize(accessor["byteOffset"], 0.0);
+	size_t elementCount = getSize(accessor["count"], 0.0);
+	size_t stride = getSize(bufferView["byteStride"], (double)elementSize);
+
+	if (elementSize == 0 || stride < elementSize || viewOffset > binarySize || viewLength > binarySize - viewOffset)
+		return view;
+	if (elementCount > 0 && (elementCount > viewLength || offset > viewLength || (elementCount - 1) * stride + elementSize > viewLength - offset))
+		return view;
+
+	view.data = binary + viewOffset + offset;
+	view.count = elementCount;
+	view.stride = stride;
+	view.componentType = type;
+	view.componentCount = count;
+	view.normalized = accessor["normalized"].getBool();
+	return view;
+}
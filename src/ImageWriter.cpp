@@ -0,0 +1,124 @@
+#include "ImageWriter.h"
+#include <algorithm>
+#include <array>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+	uint32_t crc32(uint8_t const* data, size_t size, uint32_t crc = 0)
+	{
+		static std::array<uint32_t, 256> const table = []
+		{
+			std::array<uint32_t, 256> result;
+			for (uint32_t index = 0; index < 256; index++)
+			{
+				uint32_t value = index;
+				for (int bit = 0; bit < 8; bit++)
+					value = (value & 1) ? 0xEDB88320u ^ (value >> 1) : value >> 1;
+				result[index] = value;
+			}
+			return result;
+		}();
+
+		crc = ~crc;
+		for (size_t index = 0; index < size; index++)
+			crc = table[(crc ^ data[index]) & 0xFF] ^ (crc >> 8);
+		return ~crc;
+	}
+
+	void pushBigEndian(std::vector<uint8_t>& buffer, uint32_t value)
+	{
+		buffer.push_back(value >> 24);
+		buffer.push_back(value >> 16);
+		buffer.push_back(value >> 8);
+		buffer.push_back(value);
+	}
+
+	void writeChunk(std::ofstream& stream, char const (&type)[5], std::vector<uint8_t> const& data)
+	{
+		std::vector<uint8_t> chunk;
+		chunk.reserve(data.size() + 12);
+		pushBigEndian(chunk, (uint32_t)data.size());
+		chunk.insert(chunk.end(), type, type + 4);
+		chunk.insert(chunk.end(), data.begin(), data.end());
+		pushBigEndian(chunk, crc32(chunk.data() + 4, chunk.size() - 4));
+		stream.write((char const*)chunk.data(), chunk.size());
+	}
+}
+
+bool ImageWriter::Ppm(std::string const& filePath, int width, int height, std::vector<uint8_t> const& rgb)
+{
+	std::ofstream stream(filePath, std::ios::binary);
+	if (!stream.is_open())
+	{
+		std::cerr << "error write file " + filePath << std::endl;
+		return false;
+	}
+
+	stream << "P6\n" << width << " " << height << "\n255\n";
+	stream.write((char const*)rgb.data(), (size_t)width * height * 3);
+	return stream.good();
+}
+
+bool ImageWriter::Png(std::string const& filePath, int width, int height, std::vector<uint8_t> const& rgb)
+{
+	std::ofstream stream(filePath, std::ios::binary);
+	if (!stream.is_open())
+	{
+		std::cerr << "error write file " + filePath << std::endl;
+		return false;
+	}
+
+	uint8_t const signature[] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	stream.write((char const*)signature, sizeof(signature));
+
+	std::vector<uint8_t> header;
+	pushBigEndian(header, width);
+	pushBigEndian(header, height);
+	header.insert(header.end(), { 8, 2, 0, 0, 0 }); // 8 bit, RGB, deflate, no filter, no interlace
+	writeChunk(stream, "IHDR", header);
+
+	// Scanlines with filter type 0 before each row
+	size_t rowSize = (size_t)width * 3;
+	std::vector<uint8_t> raw;
+	raw.reserve((rowSize + 1) * height);
+	for (int row = 0; row < height; row++)
+	{
+		raw.push_back(0);
+		raw.insert(raw.end(), rgb.begin() + row * rowSize, rgb.begin() + (row + 1) * rowSize);
+	}
+
+	// zlib stream from stored deflate blocks
+	size_t const maxBlock = 65535;
+	std::vector<uint8_t> zlib{ 0x78, 0x01 };
+	zlib.reserve(raw.size() + raw.size() / maxBlock * 5 + 16);
+	uint32_t adlerA = 1, adlerB = 0;
+	for (size_t offset = 0; offset < raw.size(); offset += maxBlock)
+	{
+		size_t blockSize = std::min(maxBlock, raw.size() - offset);
+		bool isLast = offset + blockSize >= raw.size();
+		zlib.push_back(isLast ? 1 : 0);
+		zlib.push_back(blockSize & 0xFF);
+		zlib.push_back(blockSize >> 8);
+		zlib.push_back(~blockSize & 0xFF);
+		zlib.push_back((~blockSize >> 8) & 0xFF);
+		zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + blockSize);
+
+		for (size_t index = offset; index < offset + blockSize; index++)
+		{
+			adlerA = (adlerA + raw[index]) % 65521;
+			adlerB = (adlerB + adlerA) % 65521;
+		}
+	}
+	pushBigEndian(zlib, (adlerB << 16) | adlerA);
+	writeChunk(stream, "IDAT", zlib);
+	writeChunk(stream, "IEND", {});
+	return stream.good();
+}
+
+bool ImageWriter::ByExtension(std::string const& filePath, int width, int height, std::vector<uint8_t> const& rgb)
+{
+	bool isPpm = filePath.size() >= 4 && filePath.compare(filePath.size() - 4, 4, ".ppm") == 0;
+	return isPpm ? Ppm(filePath, width, height, rgb) : Png(filePath, width, height, rgb);
+}
@@ -0,0 +1,50 @@
+#include "IndexedMesh.h"
+#include <utility>
+
+void IndexedMesh::assign(std::vector<float>&& position, std::vector<float>&& normal, std::vector<float>&& uv, std::vector<uint32_t>&& index)
+{
+	this->position = std::move(position);
+	this->normal = std::move(normal);
+	this->uv = std::move(uv);
+	this->index = std::move(index);
+}
+
+std::vector<float> const& IndexedMesh::getPosition() const
+{
+	return position;
+}
+
+std::vector<float> const& IndexedMesh::getNormal() const
+{
+	return normal;
+}
+
+std::vector<float> const& IndexedMesh::getUV() const
+{
+	return uv;
+}
+
+std::vector<uint32_t> const& IndexedMesh::getIndex() const
+{
+	return index;
+}
+
+std::vector<float> IndexedMesh::takePosition()
+{
+	return std::move(position);
+}
+
+std::vector<uint32_t> IndexedMesh::takeIndex()
+{
+	return std::move(index);
+}
+
+size_t IndexedMesh::getVertexCount() const
+{
+	return position.size() / 3;
+}
+
+size_t IndexedMesh::getTriangleCount() const
+{
+	return index.size() / 3;
+}
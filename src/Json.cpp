@@ -0,0 +1,254 @@
+#include "Json.h"
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+
+// Recursive descent over text, depth is limited so broken file can not overflow stack
+struct JsonParser
+{
+	char const* cursor;
+	char const* end;
+	int depth = 0;
+	static constexpr int MaxDepth = 128;
+
+	void skipSpaces()
+	{
+		while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r' || *cursor == '\n'))
+			cursor++;
+	}
+
+	bool skipChar(char symbol)
+	{
+		skipSpaces();
+		if (cursor >= end || *cursor != symbol)
+			return false;
+		cursor++;
+		return true;
+	}
+
+	bool skipWord(char const* word)
+	{
+		size_t length = strlen(word);
+		if ((size_t)(end - cursor) < length || memcmp(cursor, word, length) != 0)
+			return false;
+		cursor += length;
+		return true;
+	}
+
+	static void appendUtf8(std::string& text, uint32_t code)
+	{
+		if (code < 0x80)
+			text += (char)code;
+		else if (code < 0x800)
+		{
+			text += (char)(0xC0 | (code >> 6));
+			text += (char)(0x80 | (code & 0x3F));
+		}
+		else if (code < 0x10000)
+		{
+			text += (char)(0xE0 | (code >> 12));
+			text += (char)(0x80 | ((code >> 6) & 0x3F));
+			text += (char)(0x80 | (code & 0x3F));
+		}
+		else
+		{
+			text += (char)(0xF0 | (code >> 18));
+			text += (char)(0x80 | ((code >> 12) & 0x3F));
+			text += (char)(0x80 | ((code >> 6) & 0x3F));
+			text += (char)(0x80 | (code & 0x3F));
+		}
+	}
+
+	bool parseHex(uint32_t& code)
+	{
+		if (end - cursor < 4)
+			return false;
+		std::from_chars_result result = std::from_chars(cursor, cursor + 4, code, 16);
+		if (result.ptr != cursor + 4)
+			return false;
+		cursor += 4;
+		return true;
+	}
+
+	bool parseString(std::string& text)
+	{
+		if (!skipChar('"'))
+			return false;
+
+		while (cursor < end && *cursor != '"')
+		{
+			if (*cursor != '\\')
+			{
+				text += *cursor++;
+				continue;
+			}
+
+			if (++cursor >= end)
+				return false;
+			char escape = *cursor++;
+			switch (escape)
+			{
+			case '"': text += '"'; break;
+			case '\\': text += '\\'; break;
+			case '/': text += '/'; break;
+			case 'b': text += '\b'; break;
+			case 'f': text += '\f'; break;
+			case 'n': text += '\n'; break;
+			case 'r': text += '\r'; break;
+			case 't': text += '\t'; break;
+			case 'u':
+			{
+				uint32_t code;
+				if (!parseHex(code))
+					return false;
+				uint32_t low;
+				if (code >= 0xD800 && code < 0xDC00 && skipWord("\\u") && parseHex(low)) // surrogate pair
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				appendUtf8(text, code);
+				break;
+			}
+			default: return false;
+			}
+		}
+		return skipChar('"');
+	}
+
+	bool parseValue(JsonValue& value)
+	{
+		skipSpaces();
+		if (cursor >= end || depth > MaxDepth)
+			return false;
+
+		char symbol = *cursor;
+		if (symbol == '{')
+		{
+			cursor++;
+			value.type = JsonValue::Type::Object;
+			if (skipChar('}'))
+				return true;
+
+			depth++;
+			do
+			{
+				value.members.emplace_back();
+				if (!parseString(value.members.back().first) || !skipChar(':') || !parseValue(value.members.back().second))
+					return false;
+			} while (skipChar(','));
+			depth--;
+			return skipChar('}');
+		}
+
+		if (symbol == '[')
+		{
+			cursor++;
+			value.type = JsonValue::Type::Array;
+			if (skipChar(']'))
+				return true;
+
+			depth++;
+			do
+			{
+				value.items.emplace_back();
+				if (!parseValue(value.items.back()))
+					return false;
+			} while (skipChar(','));
+			depth--;
+			return skipChar(']');
+		}
+
+		if (symbol == '"')
+		{
+			value.type = JsonValue::Type::String;
+			return parseString(value.string);
+		}
+
+		if (skipWord("true") || skipWord("false"))
+		{
+			value.type = JsonValue::Type::Bool;
+			value.boolean = cursor[-1] == 'e' && cursor[-2] == 'u'; // "true" end with "ue"
+			return true;
+		}
+
+		if (skipWord("null"))
+			return true;
+
+		value.type = JsonValue::Type::Number;
+		std::from_chars_result result = std::from_chars(cursor, end, value.number);
+		if (result.ec != std::errc())
+			return false;
+		cursor = result.ptr;
+		return true;
+	}
+};
+
+namespace
+{
+	JsonValue const nullValue;
+}
+
+bool JsonValue::parse(char const* begin, char const* end, JsonValue& value)
+{
+	value = JsonValue();
+	JsonParser parser{ begin, end };
+	if (!parser.parseValue(value))
+		return false;
+	parser.skipSpaces();
+	while (parser.cursor < end && *parser.cursor == '\0') // GLB pads JSON chunk with spaces, some writers with zeros
+		parser.cursor++;
+	return parser.cursor == end;
+}
+
+JsonValue::Type JsonValue::getType() const
+{
+	return type;
+}
+
+bool JsonValue::isNull() const
+{
+	return type == Type::Null;
+}
+
+bool JsonValue::getBool(bool defaultValue) const
+{
+	return type == Type::Bool ? boolean : defaultValue;
+}
+
+double JsonValue::getNumber(double defaultValue) const
+{
+	return type == Type::Number ? number : defaultValue;
+}
+
+int JsonValue::getInt(int defaultValue) const
+{
+	return type == Type::Number ? (int)number : defaultValue;
+}
+
+std::string const& JsonValue::getString() const
+{
+	return string;
+}
+
+size_t JsonValue::size() const
+{
+	return type == Type::Array ? items.size() : type == Type::Object ? members.size() : 0;
+}
+
+bool JsonValue::has(char const* key) const
+{
+	return !(*this)[key].isNull();
+}
+
+JsonValue const& JsonValue::operator[](int index) const
+{
+	return type == Type::Array && index >= 0 && (size_t)index < items.size() ? items[index] : nullValue;
+}
+
+JsonValue const& JsonValue::operator[](char const* key) const
+{
+	if (type != Type::Object)
+		return nullValue;
+	for (auto const& member : members)
+		if (member.first == key)
+			return member.second;
+	return nullValue;
+}
@@ -0,0 +1,86 @@
+#include "MappedFile.h"
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+MappedFile::MappedFile(std::string const& filePath) : fileData(nullptr), fileSize(0), fileHandle(INVALID_HANDLE_VALUE), mappingHandle(nullptr)
+{
+	fileHandle = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (fileHandle == INVALID_HANDLE_VALUE)
+		return;
+
+	LARGE_INTEGER size;
+	if (!GetFileSizeEx(fileHandle, &size) || size.QuadPart == 0)
+		return;
+
+	mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (!mappingHandle)
+		return;
+
+	fileData = (char const*)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+	fileSize = fileData ? (size_t)size.QuadPart : 0;
+}
+
+MappedFile::~MappedFile()
+{
+	if (fileData)
+		UnmapViewOfFile(fileData);
+	if (mappingHandle)
+		CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(fileHandle);
+}
+#else
+MappedFile::MappedFile(std::string const& filePath) : fileData(nullptr), fileSize(0)
+{
+	int file = open(filePath.c_str(), O_RDONLY);
+	if (file < 0)
+		return;
+
+	struct stat fileStat;
+	if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+	{
+		void* mapping = mmap(nullptr, fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+		if (mapping != MAP_FAILED)
+		{
+			fileData = (char const*)mapping;
+			fileSize = fileStat.st_size;
+			madvise(mapping, fileSize, MADV_SEQUENTIAL);
+		}
+	}
+	close(file); // mapping stays valid
+}
+
+MappedFile::~MappedFile()
+{
+	if (fileData)
+		munmap((void*)fileData, fileSize);
+}
+#endif
+
+bool MappedFile::isOpen() const
+{
+	return fileData != nullptr;
+}
+
+char const* MappedFile::data() const
+{
+	return fileData;
+}
+
+size_t MappedFile::size() const
+{
+	return fileSize;
+}
@@ -0,0 +1,146 @@
+#include <glm.hpp>
+#include <algorithm>
+#include <functional>
+#include "MeshAttributes.h"
+#include "IndexedMesh.h"
+#include "Packing.h"
+#include "Ray.h"
+#include "ThreadPool.h"
+
+using glm::vec2;
+using glm::vec3;
+
+namespace
+{
+	constexpr size_t ItemsInTask = 16384;
+
+	// Task on [begin, end) ranges of items, parallel if there is pool
+	void forRanges(ThreadPool* pool, size_t count, std::function<void(size_t, size_t)> const& task)
+	{
+		int taskCount = (int)((count + ItemsInTask - 1) / ItemsInTask);
+		if (!pool || taskCount < 2)
+		{
+			task(0, count);
+			return;
+		}
+		pool->parallelFor(taskCount, [count, &task](int taskIndex)
+		{
+			size_t begin = (size_t)taskIndex * ItemsInTask;
+			task(begin, std::min(begin + ItemsInTask, count));
+		});
+	}
+
+	vec3 getPosition(std::vector<float> const& position, uint32_t vertex)
+	{
+		return vec3(position[vertex * 3], position[vertex * 3 + 1], position[vertex * 3 + 2]);
+	}
+}
+
+MeshAttributes::MeshAttributes(IndexedMesh const& mesh) : mesh(mesh) {}
+
+void MeshAttributes::build(ThreadPool* pool)
+{
+	size_t vertexCount = mesh.getVertexCount();
+	size_t triangleCount = mesh.getTriangleCount();
+	std::vector<float> const& position = mesh.getPosition();
+	std::vector<float> const& rawNormal = mesh.getNormal();
+	std::vector<float> const& rawUV = mesh.getUV();
+	bool hasNormal = rawNormal.size() == vertexCount * 3;
+	bool hasUV = rawUV.size() == vertexCount * 2;
+	std::vector<uint32_t> const& meshIndex = mesh.getIndex();
+	packed.resize(vertexCount * 4);
+	faceNormal.resize(triangleCount);
+
+	// Geometric normal of every triangle for renderers, encoding is the costly part
+	forRanges(pool, triangleCount, [&](size_t begin, size_t end)
+	{
+		for (size_t triangle = begin; triangle < end; triangle++)
+		{
+			vec3 v1 = getPosition(position, meshIndex[triangle * 3]);
+			vec3 normal = glm::cross(getPosition(position, meshIndex[triangle * 3 + 1]) - v1, getPosition(position, meshIndex[triangle * 3 + 2]) - v1);
+			bool isDegenerate = normal.x == 0.0f && normal.y == 0.0f && normal.z == 0.0f;
+			faceNormal[triangle] = isDegenerate ? 0 : Packing::packSnorm2x16(Packing::octEncode(normal)); // octEncode scale to unit L1 norm itself
+		}
+	});
+
+	// Triangles of every vertex (CSR), so area weighted sums are gathered per vertex in parallel.
+	// Triangles are in index order, sum order and result are the same with any thread count
+	std::vector<uint32_t> firstAdjacent;
+	std::vector<uint32_t> adjacent;
+	if (!hasNormal)
+	{
+		firstAdjacent.assign(vertexCount + 1, 0);
+		for (uint32_t vertex : meshIndex)
+			firstAdjacent[vertex + 1]++;
+		for (size_t vertex = 0; vertex < vertexCount; vertex++)
+			firstAdjacent[vertex + 1] += firstAdjacent[vertex];
+		adjacent.resize(meshIndex.size());
+		std::vector<uint32_t> cursor(firstAdjacent.begin(), firstAdjacent.end() - 1);
+		for (size_t corner = 0; corner < meshIndex.size(); corner++)
+			adjacent[cursor[meshIndex[corner]]++] = (uint32_t)(corner / 3);
+	}
+
+	// Cross product is computed again for every corner, it is cheaper than storing vec3 per triangle
+	auto vertexNormalSum = [&](size_t vertex)
+	{
+		vec3 sum(0.0f);
+		for (uint32_t item = firstAdjacent[vertex]; item < firstAdjacent[vertex + 1]; item++)
+		{
+			size_t corner = (size_t)adjacent[item] * 3;
+			vec3 v1 = getPosition(position, meshIndex[corner]);
+			sum += glm::cross(getPosition(position, meshIndex[corner + 1]) - v1, getPosition(position, meshIndex[corner + 2]) - v1); // length is twice area
+		}
+		return sum;
+	};
+
+	forRanges(pool, vertexCount, [&](size_t begin, size_t end)
+	{
+		for (size_t vertex = begin; vertex < end; vertex++)
+		{
+			vec3 sum = hasNormal ? vec3(rawNormal[vertex * 3], rawNormal[vertex * 3 + 1], rawNormal[vertex * 3 + 2]) : vertexNormalSum(vertex);
+			vec2 encoded = glm::length(sum) > 0.0f ? Packing::octEncode(glm::normalize(sum)) : vec2(0.0f, 0.0f);
+			uint16_t* data = &packed[vertex * 4];
+			data[0] = Packing::floatToHalf(encoded.x);
+			data[1] = Packing::floatToHalf(encoded.y);
+			data[2] = Packing::floatToHalf(hasUV ? rawUV[vertex * 2] : 0.0f);
+			data[3] = Packing::floatToHalf(hasUV ? rawUV[vertex * 2 + 1] : 0.0f);
+		}
+	});
+}
+
+void MeshAttributes::resolve(Hit& hit) const
+{
+	if (!hit.isHit)
+		return;
+
+	std::vector<uint32_t> const& index = mesh.getIndex();
+	vec3 weight(1.0f - hit.barycentric.x - hit.barycentric.y, hit.barycentric.x, hit.barycentric.y);
+	vec3 normal(0.0f);
+	vec2 uv(0.0f);
+
+	for (int corner = 0; corner < 3; corner++)
+	{
+		uint16_t const* data = &packed[(size_t)index[(size_t)hit.triangleIndex * 3 + corner] * 4];
+		vec2 encoded(Packing::halfToFloat(data[0]), Packing::halfToFloat(data[1]));
+		normal += Packing::octDecode(encoded) * weight[corner];
+		uv += vec2(Packing::halfToFloat(data[2]), Packing::halfToFloat(data[3])) * weight[corner];
+	}
+
+	hit.normal = glm::length(normal) > 0.0f ? glm::normalize(normal) : getFaceNormal(hit.triangleIndex);
+	hit.uv = uv;
+}
+
+glm::vec3 MeshAttributes::getFaceNormal(int triangleIndex) const
+{
+	return Packing::octDecode(Packing::unpackSnorm2x16(faceNormal[triangleIndex]));
+}
+
+std::vector<uint16_t> const& MeshAttributes::getPacked() const
+{
+	return packed;
+}
+
+int MeshAttributes::getVertexCount() const
+{
+	return (int)(packed.size() / 4);
+}
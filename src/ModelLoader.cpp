@@ -1,7 +1,456 @@
 #include "ModelLoader.h"
+#include <glm.hpp>
+#include <gtc/matrix_transform.hpp>
+#include <gtc/quaternion.hpp>
+#include <gtc/type_ptr.hpp>
 #include <iostream>
 #include <fstream>
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <unordered_map>
 #include "Utils.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include "IndexedMesh.h"
+#include "GltfFile.h"
+#include "DecompressStream.h"
+
+namespace
+{
+    enum class ObjLine
+    {
+        Vertex,
+        UV,
+        Normal,
+        Face,
+        Other
+    };
+
+    // Tokenizer over mapped text, no copy of lines and no locale
+    struct ObjScanner
+    {
+        char const* cursor;
+        char const* end;
+
+        bool isEnd() const { return cursor >= end; }
+
+        void skipSpaces()
+        {
+            while (cursor < end && (*cursor == ' ' || *cursor == '\t' || *cursor == '\r'))
+                cursor++;
+        }
+
+        void skipLine()
+        {
+            char const* lineEnd = (char const*)memchr(cursor, '\n', end - cursor);
+            cursor = lineEnd ? lineEnd + 1 : end;
+        }
+
+        bool skipChar(char symbol)
+        {
+            if (cursor >= end || *cursor != symbol)
+                return false;
+            cursor++;
+            return true;
+        }
+
+        // Read keyword at line begin and stay after it
+        ObjLine lineType()
+        {
+            skipSpaces();
+            size_t left = end - cursor;
+            auto isSpace = [](char symbol) { return symbol == ' ' || symbol == '\t'; };
+
+            if (left >= 2 && cursor[0] == 'v' && isSpace(cursor[1]))
+            {
+                cursor += 1;
+                return ObjLine::Vertex;
+            }
+            if (left >= 3 && cursor[0] == 'v' && cursor[1] == 't' && isSpace(cursor[2]))
+            {
+                cursor += 2;
+                return ObjLine::UV;
+            }
+            if (left >= 3 && cursor[0] == 'v' && cursor[1] == 'n' && isSpace(cursor[2]))
+            {
+                cursor += 2;
+                return ObjLine::Normal;
+            }
+            if (left >= 2 && cursor[0] == 'f' && isSpace(cursor[1]))
+            {
+                cursor += 1;
+                return ObjLine::Face;
+            }
+            return ObjLine::Other;
+        }
+
+        bool parseFloat(float& value)
+        {
+            skipSpaces();
+            if (cursor < end && *cursor == '+') // from_chars do not accept plus
+                cursor++;
+            std::from_chars_result result = std::from_chars(cursor, end, value);
+            if (result.ec != std::errc())
+                return false;
+            cursor = result.ptr;
+            return true;
+        }
+
+        bool parseInt(int& value)
+        {
+            std::from_chars_result result = std::from_chars(cursor, end, value);
+            if (result.ec != std::errc())
+                return false;
+            cursor = result.ptr;
+            return true;
+        }
+
+        bool isSpace() const
+        {
+            return *cursor == ' ' || *cursor == '\t' || *cursor == '\r';
+        }
+
+        bool isLineEnd() const
+        {
+            return cursor >= end || *cursor == '\n' || *cursor == '#';
+        }
+
+        // Face corner "v", "v/t", "v//n" or "v/t/n", missing index is 0
+        bool parseCorner(int& vertex, int& uv, int& normal)
+        {
+            uv = 0;
+            normal = 0;
+            if (!parseInt(vertex))
+                return false;
+            if (skipChar('/'))
+            {
+                if ((cursor >= end || *cursor != '/') && !parseInt(uv))
+                    return false;
+                if (skipChar('/') && !parseInt(normal))
+                    return false;
+            }
+            return cursor >= end || isSpace() || *cursor == '\n';
+        }
+
+        // Corner count of face line for first pass, without number parsing. Cursor stay at line end
+        void countCorners(size_t& cornerCount, bool& hasUV, bool& hasNormal)
+        {
+            cornerCount = 0;
+            while (true)
+            {
+                skipSpaces();
+                if (isLineEnd())
+                    return;
+
+                char const* slash[2] = { nullptr, nullptr };
+                int slashCount = 0;
+                for (; cursor < end && !isSpace() && *cursor != '\n'; cursor++)
+                    if (*cursor == '/' && slashCount < 2)
+                        slash[slashCount++] = cursor;
+
+                cornerCount++;
+                hasUV = hasUV && slashCount > 0 && (slashCount == 1 ? cursor : slash[1]) > slash[0] + 1;
+                hasNormal = hasNormal && slashCount == 2;
+            }
+        }
+    };
+
+    // OBJ index is 1 based, negative is relative to elements defined before the line
+    bool resolveIndex(int index, size_t definedCount, size_t& resolved)
+    {
+        if (index > 0)
+            resolved = (size_t)index - 1;
+        else if (index < 0 && (size_t)-index <= definedCount)
+            resolved = definedCount + index;
+        else
+            return false;
+        return true;
+    }
+
+    // Newline aligned part of file, counts from first pass and global offsets from prefix sum
+    struct ObjChunk
+    {
+        char const* begin = nullptr;
+        char const* end = nullptr;
+        size_t vertexCount = 0;
+        size_t uvCount = 0;
+        size_t normalCount = 0;
+        size_t triangleCount = 0;
+        size_t vertexOffset = 0;
+        size_t uvOffset = 0;
+        size_t normalOffset = 0;
+        size_t triangleOffset = 0;
+        size_t writtenTriangles = 0;
+        size_t badLineCount = 0;
+        bool hasAllUV = true;     // every face corner has vt index
+        bool hasAllNormal = true; // every face corner has vn index
+    };
+
+    constexpr size_t MinObjChunkSize = 256 * 1024;
+
+    std::vector<ObjChunk> splitObjChunks(char const* data, size_t size, size_t chunkCount)
+    {
+        chunkCount = std::max<size_t>(1, std::min(chunkCount, size / MinObjChunkSize));
+        std::vector<ObjChunk> chunks;
+        char const* begin = data;
+        char const* end = data + size;
+        for (size_t index = 1; index <= chunkCount && begin < end; index++)
+        {
+            char const* chunkEnd = index == chunkCount ? end : data + size / chunkCount * index;
+            if (chunkEnd < begin)
+                continue;
+            char const* lineEnd = (char const*)memchr(chunkEnd, '\n', end - chunkEnd);
+            chunkEnd = lineEnd ? lineEnd + 1 : end;
+
+            ObjChunk chunk;
+            chunk.begin = begin;
+            chunk.end = chunkEnd;
+            chunks.push_back(chunk);
+            begin = chunkEnd;
+        }
+        return chunks;
+    }
+
+    void forEachChunk(ThreadPool* pool, std::vector<ObjChunk>& chunks, std::function<void(ObjChunk&)> const& task)
+    {
+        if (pool && chunks.size() > 1)
+            pool->parallelFor((int)chunks.size(), [&chunks, &task](int index) { task(chunks[index]); });
+        else
+            for (ObjChunk& chunk : chunks)
+                task(chunk);
+    }
+
+    // v, vt and vn of whole file and chunk offsets, shared by expanded and indexed output.
+    // Chunks point to text of mapped file or of decompressed blocks, both kept until faces are read.
+    // Decompressed text is heap memory, so compressed OBJ needs memory for the whole decompressed text
+    struct ObjElements
+    {
+        std::vector<ObjChunk> chunks;
+        std::vector<float> vertex;
+        std::vector<float> normal;
+        std::vector<float> uv;
+        size_t triangleCount = 0;
+        bool hasUV = false;     // faces use vt, else vt indices are ignored and mesh has no uv
+        bool hasNormal = false; // same for vn
+        std::unique_ptr<MappedFile> file;
+        std::vector<std::vector<char>> text;
+    };
+
+    // Pass 1 and 2 over newline ended text, its chunks continue after text appended before
+    void appendObjElements(char const* data, size_t size, ThreadPool* pool, ObjElements& elements)
+    {
+        size_t chunkCount = pool ? pool->getThreadCount() * 4 : 1;
+        std::vector<ObjChunk> chunks = splitObjChunks(data, size, chunkCount);
+
+        // Pass 1: count elements of every chunk
+        forEachChunk(pool, chunks, [](ObjChunk& chunk)
+        {
+            ObjScanner scanner{ chunk.begin, chunk.end };
+            while (!scanner.isEnd())
+            {
+                switch (scanner.lineType())
+                {
+                case ObjLine::Vertex: chunk.vertexCount++; break;
+                case ObjLine::UV: chunk.uvCount++; break;
+                case ObjLine::Normal: chunk.normalCount++; break;
+                case ObjLine::Face:
+                {
+                    size_t cornerCount;
+                    scanner.countCorners(cornerCount, chunk.hasAllUV, chunk.hasAllNormal);
+                    chunk.triangleCount += cornerCount >= 3 ? cornerCount - 2 : 0; // polygon is fan
+                    break;
+                }
+                default: break;
+                }
+                scanner.skipLine();
+            }
+        });
+
+        // Prefix sum gives where every chunk writes and how many elements are defined before it
+        size_t vertexCount = elements.vertex.size() / 3;
+        size_t uvCount = elements.uv.size() / 2;
+        size_t normalCount = elements.normal.size() / 3;
+        size_t triangleCount = elements.triangleCount;
+        for (ObjChunk& chunk : chunks)
+        {
+            chunk.vertexOffset = vertexCount;
+            chunk.uvOffset = uvCount;
+            chunk.normalOffset = normalCount;
+            chunk.triangleOffset = triangleCount;
+            vertexCount += chunk.vertexCount;
+            uvCount += chunk.uvCount;
+            normalCount += chunk.normalCount;
+            triangleCount += chunk.triangleCount;
+        }
+
+        std::vector<float>& tempVertex = elements.vertex;
+        std::vector<float>& tempNormal = elements.normal;
+        std::vector<float>& tempuv = elements.uv;
+        tempVertex.resize(vertexCount * 3);
+        tempNormal.resize(normalCount * 3);
+        tempuv.resize(uvCount * 2);
+        elements.triangleCount = triangleCount;
+
+        // Pass 2: vertex data, faces may use vertices of any chunk so they wait for all chunks
+        forEachChunk(pool, chunks, [&tempVertex, &tempNormal, &tempuv](ObjChunk& chunk)
+        {
+            float* vertexOut = tempVertex.data() + chunk.vertexOffset * 3;
+            float* normalOut = tempNormal.data() + chunk.normalOffset * 3;
+            float* uvOut = tempuv.data() + chunk.uvOffset * 2;
+
+            ObjScanner scanner{ chunk.begin, chunk.end };
+            while (!scanner.isEnd())
+            {
+                ObjLine line = scanner.lineType();
+                bool isGood = true;
+
+                if (line == ObjLine::Vertex)
+                {
+                    isGood = scanner.parseFloat(vertexOut[0]) && scanner.parseFloat(vertexOut[1]) && scanner.parseFloat(vertexOut[2]);
+                    vertexOut += 3;
+                }
+
+                if (line == ObjLine::UV)
+                {
+                    isGood = scanner.parseFloat(uvOut[0]) && scanner.parseFloat(uvOut[1]);
+                    uvOut += 2;
+                }
+
+                if (line == ObjLine::Normal)
+                {
+                    isGood = scanner.parseFloat(normalOut[0]) && scanner.parseFloat(normalOut[1]) && scanner.parseFloat(normalOut[2]);
+                    normalOut += 3;
+                }
+
+                chunk.badLineCount += !isGood;
+                scanner.skipLine();
+            }
+        });
+        elements.chunks.insert(elements.chunks.end(), chunks.begin(), chunks.end());
+    }
+
+    // Compressed file is parsed block by block while next blocks are decompressed,
+    // line cut by block end is carried to the next block. Text of every block is kept for the face pass
+    bool loadCompressedObjElements(std::string const& filePath, ThreadPool* pool, ObjElements& elements)
+    {
+        DecompressStream stream(Utils::resourceDir + filePath);
+        if (!stream.isOpen())
+        {
+            std::cerr << "error load file " + filePath << std::endl;
+            return false;
+        }
+
+        std::vector<char> block;
+        std::vector<char> carry;
+        while (stream.read(block))
+        {
+            auto lineEnd = std::find(block.rbegin(), block.rend(), '\n').base();
+            if (lineEnd == block.begin())
+            {
+                carry.insert(carry.end(), block.begin(), block.end()); // line longer than block
+                continue;
+            }
+
+            std::vector<char> text;
+            text.reserve(carry.size() + (lineEnd - block.begin()));
+            text.insert(text.end(), carry.begin(), carry.end());
+            text.insert(text.end(), block.begin(), lineEnd);
+            carry.assign(lineEnd, block.end());
+            appendObjElements(text.data(), text.size(), pool, elements);
+            elements.text.push_back(std::move(text));
+        }
+
+        if (!stream.isGood())
+            return false; // worker reported broken or truncated data
+
+        if (!carry.empty())
+        {
+            appendObjElements(carry.data(), carry.size(), pool, elements);
+            elements.text.push_back(std::move(carry));
+        }
+        return true;
+    }
+
+    // Mapped file is parsed at once, vt and vn are used only if every face corner has them
+    bool loadObjElements(std::string const& filePath, ThreadPool* pool, ObjElements& elements)
+    {
+        if (!DecompressStream::isCompressed(filePath))
+        {
+            elements.file = std::make_unique<MappedFile>(Utils::resourceDir + filePath);
+            if (!elements.file->isOpen())
+            {
+                std::cerr << "error load file " + filePath << std::endl;
+                return false;
+            }
+            appendObjElements(elements.file->data(), elements.file->size(), pool, elements);
+        }
+        else if (!loadCompressedObjElements(filePath, pool, elements))
+            return false;
+
+        elements.hasUV = !elements.uv.empty();
+        elements.hasNormal = !elements.normal.empty();
+        for (ObjChunk const& chunk : elements.chunks)
+        {
+            elements.hasUV = elements.hasUV && chunk.hasAllUV;
+            elements.hasNormal = elements.hasNormal && chunk.hasAllNormal;
+        }
+        return true;
+    }
+
+    // Element indices of face corner, uv and normal are 0 when mesh does not use them
+    struct ObjCorner
+    {
+        size_t vertex = 0;
+        size_t uv = 0;
+        size_t normal = 0;
+    };
+
+    // v/vt/vn of welded vertex, each index fits 32 bits as unique vertex index does
+    struct CornerKey
+    {
+        uint32_t vertex;
+        uint32_t uv;
+        uint32_t normal;
+
+        bool operator==(CornerKey const& other) const { return vertex == other.vertex && uv == other.uv && normal == other.normal; }
+    };
+
+    struct CornerKeyHash
+    {
+        size_t operator()(CornerKey const& key) const
+        {
+            uint64_t hash = ((uint64_t)key.vertex << 32 | key.uv) * 0x9E3779B97F4A7C15ull;
+            hash ^= (hash >> 29) ^ ((uint64_t)key.normal * 0xBF58476D1CE4E5B9ull);
+            return (size_t)(hash ^ (hash >> 32));
+        }
+    };
+
+    // Read all corners of face line, false if face has less than 3 corners or any index is broken
+    bool readObjFace(ObjScanner& scanner, ObjElements const& elements, size_t definedVertex, size_t definedUV, size_t definedNormal, std::vector<ObjCorner>& corners)
+    {
+        corners.clear();
+        while (true)
+        {
+            scanner.skipSpaces();
+            if (scanner.isLineEnd())
+                return corners.size() >= 3;
+
+            int v, t, n;
+            ObjCorner corner;
+            if (!scanner.parseCorner(v, t, n) || !resolveIndex(v, definedVertex, corner.vertex) || corner.vertex * 3 >= elements.vertex.size())
+                return false;
+            if (elements.hasUV && (!resolveIndex(t, definedUV, corner.uv) || corner.uv * 2 >= elements.uv.size()))
+                return false;
+            if (elements.hasNormal && (!resolveIndex(n, definedNormal, corner.normal) || corner.normal * 3 >= elements.normal.size()))
+                return false;
+            corners.push_back(corner);
+        }
+    }
+}
 
 void ModelLoader::Obj(std::string const& filePath, std::vector<float>& rawVertex, std::vector<float>& rawNormal, std::vector<float>& rawUV)
 {
@@ -72,3 +521,869 @@ void ModelLoader::Obj(std::string const& filePath, std::vector<float>& rawVertex
         }
     }
 }
+
+void ModelLoader::ObjMapped(std::string const& filePath, std::vector<float>& rawVertex, std::vector<float>& rawNormal, std::vector<float>& rawUV, ThreadPool* pool)
+{
+    rawVertex.clear();
+    rawNormal.clear();
+    rawUV.clear();
+
+    ObjElements elements;
+    if (!loadObjElements(filePath, pool, elements))
+        return;
+    std::vector<ObjChunk>& chunks = elements.chunks;
+    std::vector<float> const& tempVertex = elements.vertex;
+    std::vector<float> const& tempNormal = elements.normal;
+    std::vector<float> const& tempuv = elements.uv;
+    bool hasNormal = elements.hasNormal;
+    bool hasUV = elements.hasUV;
+    rawVertex.resize(elements.triangleCount * 9);
+    rawNormal.resize(hasNormal ? elements.triangleCount * 9 : 0);
+    rawUV.resize(hasUV ? elements.triangleCount * 6 : 0);
+
+    // Pass 3: expand faces straight into output buffers, polygon as fan around first corner
+    forEachChunk(pool, chunks, [&](ObjChunk& chunk)
+    {
+        float* rawVertexOut = rawVertex.data() + chunk.triangleOffset * 9;
+        float* rawNormalOut = rawNormal.data() + chunk.triangleOffset * 9;
+        float* rawUVOut = rawUV.data() + chunk.triangleOffset * 6;
+        size_t definedVertex = chunk.vertexOffset;
+        size_t definedUV = chunk.uvOffset;
+        size_t definedNormal = chunk.normalOffset;
+        std::vector<ObjCorner> corners;
+
+        ObjScanner scanner{ chunk.begin, chunk.end };
+        while (!scanner.isEnd())
+        {
+            ObjLine line = scanner.lineType();
+            definedVertex += line == ObjLine::Vertex;
+            definedUV += line == ObjLine::UV;
+            definedNormal += line == ObjLine::Normal;
+
+            if (line == ObjLine::Face)
+            {
+                bool isGood = readObjFace(scanner, elements, definedVertex, definedUV, definedNormal, corners);
+                for (size_t last = 2; last < corners.size() && isGood; last++)
+                {
+                    for (size_t fan : { (size_t)0, last - 1, last })
+                    {
+                        ObjCorner const& corner = corners[fan];
+                        rawVertexOut = std::copy_n(&tempVertex[corner.vertex * 3], 3, rawVertexOut);
+                        if (hasNormal)
+                            rawNormalOut = std::copy_n(&tempNormal[corner.normal * 3], 3, rawNormalOut);
+                        if (hasUV)
+                            rawUVOut = std::copy_n(&tempuv[corner.uv * 2], 2, rawUVOut);
+                    }
+                }
+                chunk.badLineCount += !isGood;
+            }
+            scanner.skipLine();
+        }
+        chunk.writtenTriangles = (rawVertexOut - rawVertex.data()) / 9 - chunk.triangleOffset;
+    });
+
+    // Skipped faces leave holes at the end of chunks, move data down
+    auto compact = [&chunks](std::vector<float>& data, size_t floatCount)
+    {
+        size_t writtenTriangles = 0;
+        for (ObjChunk const& chunk : chunks)
+        {
+            if (writtenTriangles != chunk.triangleOffset && !data.empty())
+                memmove(data.data() + writtenTriangles * floatCount, data.data() + chunk.triangleOffset * floatCount, chunk.writtenTriangles * floatCount * sizeof(float));
+            writtenTriangles += chunk.writtenTriangles;
+        }
+        data.resize(data.empty() ? 0 : writtenTriangles * floatCount);
+    };
+    compact(rawVertex, 9);
+    compact(rawNormal, 9);
+    compact(rawUV, 6);
+
+    size_t badLineCount = 0;
+    for (ObjChunk const& chunk : chunks)
+        badLineCount += chunk.badLineCount;
+
+    if (badLineCount)
+        std::cerr << filePath << ": skipped " << badLineCount << " unsupported lines" << std::endl;
+}
+
+void ModelLoader::ObjIndexed(std::string const& filePath, IndexedMesh& mesh, ThreadPool* pool)
+{
+    mesh = IndexedMesh();
+
+    ObjElements elements;
+    if (!loadObjElements(filePath, pool, elements))
+        return;
+    size_t vertexCount = elements.vertex.size() / 3;
+
+    std::vector<float> position, normal, uv;
+    std::vector<uint32_t> index;
+    position.reserve(elements.vertex.size());
+    normal.reserve(elements.hasNormal ? elements.vertex.size() : 0);
+    uv.reserve(elements.hasUV ? vertexCount * 2 : 0);
+    index.reserve(elements.triangleCount * 3);
+
+    // Pass 3: weld corners by v/vt/vn index. Usually position has one uv and normal,
+    // so first use is found in flat array and only other combinations go to hash map
+    constexpr uint32_t NoVertex = UINT32_MAX;
+    std::vector<uint32_t> firstUnique(vertexCount, NoVertex);
+    std::vector<std::pair<uint32_t, uint32_t>> uniqueSource; // uv and normal of unique vertex
+    std::unordered_map<CornerKey, uint32_t, CornerKeyHash> otherUnique;
+    uniqueSource.reserve(vertexCount);
+
+    auto weld = [&](size_t v, size_t t, size_t n)
+    {
+        uint32_t& first = firstUnique[v];
+        if (first != NoVertex && uniqueSource[first] == std::make_pair((uint32_t)t, (uint32_t)n))
+            return first;
+
+        CornerKey key{ (uint32_t)v, (uint32_t)t, (uint32_t)n };
+        if (first != NoVertex)
+        {
+            auto found = otherUnique.find(key);
+            if (found != otherUnique.end())
+                return found->second;
+        }
+
+        uint32_t vertex = (uint32_t)uniqueSource.size();
+        uniqueSource.emplace_back((uint32_t)t, (uint32_t)n);
+        position.insert(position.end(), &elements.vertex[v * 3], &elements.vertex[v * 3] + 3);
+        if (elements.hasNormal)
+            normal.insert(normal.end(), &elements.normal[n * 3], &elements.normal[n * 3] + 3);
+        if (elements.hasUV)
+            uv.insert(uv.end(), &elements.uv[t * 2], &elements.uv[t * 2] + 2);
+        if (first == NoVertex)
+            first = vertex;
+        else
+            otherUnique.emplace(key, vertex);
+        return vertex;
+    };
+
+    size_t badLineCount = 0;
+    std::vector<ObjCorner> corners;
+    for (ObjChunk& chunk : elements.chunks)
+    {
+        size_t definedVertex = chunk.vertexOffset;
+        size_t definedUV = chunk.uvOffset;
+        size_t definedNormal = chunk.normalOffset;
+        badLineCount += chunk.badLineCount;
+
+        ObjScanner scanner{ chunk.begin, chunk.end };
+        while (!scanner.isEnd())
+        {
+            ObjLine line = scanner.lineType();
+            definedVertex += line == ObjLine::Vertex;
+            definedUV += line == ObjLine::UV;
+            definedNormal += line == ObjLine::Normal;
+
+            if (line == ObjLine::Face)
+            {
+                bool isGood = readObjFace(scanner, elements, definedVertex, definedUV, definedNormal, corners);
+                if (isGood)
+                {
+                    uint32_t first = weld(corners[0].vertex, corners[0].uv, corners[0].normal);
+                    uint32_t previous = weld(corners[1].vertex, corners[1].uv, corners[1].normal);
+                    for (size_t last = 2; last < corners.size(); last++)
+                    {
+                        uint32_t current = weld(corners[last].vertex, corners[last].uv, corners[last].normal);
+                        index.insert(index.end(), { first, previous, current });
+                        previous = current;
+                    }
+                }
+                badLineCount += !isGood;
+            }
+            scanner.skipLine();
+        }
+    }
+
+    mesh.assign(std::move(position), std::move(normal), std::move(uv), std::move(index));
+
+    if (badLineCount)
+        std::cerr << filePath << ": skipped " << badLineCount << " unsupported lines" << std::endl;
+}
+
+namespace
+{
+    enum class PlyType
+    {
+        Int8,
+        UInt8,
+        Int16,
+        UInt16,
+        Int32,
+        UInt32,
+        Float32,
+        Float64,
+        None
+    };
+
+    struct PlyProperty
+    {
+        std::string name;
+        PlyType type = PlyType::None;
+        PlyType countType = PlyType::None; // type of list length, None for scalar property
+    };
+
+    struct PlyElement
+    {
+        std::string name;
+        size_t count = 0;
+        std::vector<PlyProperty> properties;
+
+        int find(std::initializer_list<char const*> names) const
+        {
+            for (char const* name : names)
+                for (size_t index = 0; index < properties.size(); index++)
+                    if (properties[index].name == name)
+                        return (int)index;
+            return -1;
+        }
+    };
+
+    PlyType plyType(std::string const& name)
+    {
+        if (name == "char" || name == "int8") return PlyType::Int8;
+        if (name == "uchar" || name == "uint8") return PlyType::UInt8;
+        if (name == "short" || name == "int16") return PlyType::Int16;
+        if (name == "ushort" || name == "uint16") return PlyType::UInt16;
+        if (name == "int" || name == "int32") return PlyType::Int32;
+        if (name == "uint" || name == "uint32") return PlyType::UInt32;
+        if (name == "float" || name == "float32") return PlyType::Float32;
+        if (name == "double" || name == "float64") return PlyType::Float64;
+        return PlyType::None;
+    }
+
+    size_t plyTypeSize(PlyType type)
+    {
+        static size_t const sizes[] = { 1, 1, 2, 2, 4, 4, 4, 8, 0 };
+        return sizes[(int)type];
+    }
+
+    template<typename T>
+    double plyBinaryValue(char const* bytes)
+    {
+        T value;
+        memcpy(&value, bytes, sizeof(T));
+        return (double)value;
+    }
+
+    // Values of ASCII or binary body one by one, binary is swapped when file endian differ from machine.
+    // Body of compressed file comes in blocks, unread rest of block is moved in front of the next one
+    struct PlyReader
+    {
+        char const* cursor;
+        char const* end;
+        bool isBinary;
+        bool isSwap;
+        DecompressStream* stream = nullptr;
+        std::vector<char> buffer;
+
+        bool refill()
+        {
+            std::vector<char> block;
+            if (!stream || !stream->read(block))
+                return false;
+            block.insert(block.begin(), cursor, end);
+            buffer = std::move(block);
+            cursor = buffer.data();
+            end = cursor + buffer.size();
+            return true;
+        }
+
+        // At least size bytes are after cursor, false at end of body
+        bool ensure(size_t size)
+        {
+            while ((size_t)(end - cursor) < size)
+                if (!refill())
+                    return false;
+            return true;
+        }
+
+        bool read(PlyType type, double& value)
+        {
+            if (!isBinary)
+            {
+                auto isSpace = [](char symbol) { return symbol == ' ' || symbol == '\t' || symbol == '\r' || symbol == '\n'; };
+                while (cursor < end && isSpace(*cursor))
+                    cursor++;
+                if (stream)
+                {
+                    // Number must end before block end, else it may continue in next block
+                    char const* wordEnd = cursor;
+                    while (wordEnd < end && !isSpace(*wordEnd))
+                        wordEnd++;
+                    if (wordEnd == end && refill())
+                        return read(type, value);
+                }
+                if (cursor < end && *cursor == '+')
+                    cursor++;
+                std::from_chars_result result = std::from_chars(cursor, end, value);
+                if (result.ec != std::errc())
+                    return false;
+                cursor = result.ptr;
+                return true;
+            }
+
+            size_t size = plyTypeSize(type);
+            if (!ensure(size))
+                return false;
+
+            char swapped[8];
+            char const* bytes = cursor;
+            if (isSwap)
+            {
+                std::reverse_copy(cursor, cursor + size, swapped);
+                bytes = swapped;
+            }
+            cursor += size;
+
+            switch (type)
+            {
+            case PlyType::Int8: value = plyBinaryValue<int8_t>(bytes); break;
+            case PlyType::UInt8: value = plyBinaryValue<uint8_t>(bytes); break;
+            case PlyType::Int16: value = plyBinaryValue<int16_t>(bytes); break;
+            case PlyType::UInt16: value = plyBinaryValue<uint16_t>(bytes); break;
+            case PlyType::Int32: value = plyBinaryValue<int32_t>(bytes); break;
+            case PlyType::UInt32: value = plyBinaryValue<uint32_t>(bytes); break;
+            case PlyType::Float32: value = plyBinaryValue<float>(bytes); break;
+            case PlyType::Float64: value = plyBinaryValue<double>(bytes); break;
+            default: return false;
+            }
+            return true;
+        }
+
+        // Read whole property, list values go to listValues
+        bool readProperty(PlyProperty const& property, double& value, std::vector<double>& listValues)
+        {
+            if (property.countType == PlyType::None)
+                return read(property.type, value);
+
+            double count;
+            if (!read(property.countType, count) || count < 0.0)
+                return false;
+            listValues.resize((size_t)count);
+            for (double& item : listValues)
+                if (!read(property.type, item))
+                    return false;
+            return true;
+        }
+    };
+
+    bool parsePlyHeader(char const* data, size_t size, std::vector<PlyElement>& elements, PlyReader& reader)
+    {
+        ObjScanner scanner{ data, data + size };
+        std::string format;
+        bool isPly = false;
+
+        while (!scanner.isEnd())
+        {
+            char const* lineBegin = scanner.cursor;
+            scanner.skipLine();
+            std::istringstream words(std::string(lineBegin, scanner.cursor));
+            std::string keyword;
+            words >> keyword;
+
+            if (keyword == "ply")
+                isPly = true;
+            else if (keyword == "format")
+                words >> format;
+            else if (keyword == "element")
+            {
+                elements.emplace_back();
+                words >> elements.back().name >> elements.back().count;
+            }
+            else if (keyword == "property" && !elements.empty())
+            {
+                PlyProperty property;
+                std::string type;
+                words >> type;
+                if (type == "list")
+                {
+                    std::string countType;
+                    words >> countType >> type;
+                    property.countType = plyType(countType);
+                    if (property.countType == PlyType::None)
+                        return false;
+                }
+                property.type = plyType(type);
+                words >> property.name;
+                if (property.type == PlyType::None)
+                    return false;
+                elements.back().properties.push_back(property);
+            }
+            else if (keyword == "end_header")
+            {
+                uint16_t probe = 1;
+                bool isLittleMachine = *(uint8_t*)&probe == 1;
+                reader.cursor = scanner.cursor;
+                reader.end = data + size;
+                reader.isBinary = format != "ascii";
+                reader.isSwap = (format == "binary_little_endian" && !isLittleMachine) || (format == "binary_big_endian" && isLittleMachine);
+                return isPly && (format == "ascii" || format == "binary_little_endian" || format == "binary_big_endian");
+            }
+        }
+        return false;
+    }
+
+    // Binary body in machine order with scalar properties only: records have fixed size, offset of every property is known
+    bool plyFixedLayout(PlyElement const& element, PlyReader const& reader, std::vector<size_t>& offset, size_t& stride)
+    {
+        if (!reader.isBinary || reader.isSwap)
+            return false;
+        offset.clear();
+        stride = 0;
+        for (PlyProperty const& property : element.properties)
+        {
+            if (property.countType != PlyType::None)
+                return false;
+            offset.push_back(stride);
+            stride += plyTypeSize(property.type);
+        }
+        return true;
+    }
+
+    // Fast path of vertex element with float32 fields: fields are copied from fixed offsets of every record in buffer.
+    // fieldOffset is x, y, z, then normal and uv when vertex has them
+    bool readPlyFloatVertices(PlyReader& reader, size_t count, size_t stride, std::vector<size_t> const& fieldOffset, std::vector<float>& position, std::vector<float>& normal, std::vector<float>& uv)
+    {
+        bool hasNormal = fieldOffset.size() == 6 || fieldOffset.size() == 8;
+        bool hasUV = fieldOffset.size() == 5 || fieldOffset.size() == 8;
+        position.resize(count * 3);
+        normal.resize(hasNormal ? count * 3 : 0);
+        uv.resize(hasUV ? count * 2 : 0);
+        size_t const* offset = fieldOffset.data();
+        size_t uvField = hasNormal ? 6 : 3;
+        float* outPosition = position.data();
+        float* outNormal = normal.data();
+        float* outUV = uv.data();
+
+        size_t item = 0;
+        while (item < count)
+        {
+            if (!reader.ensure(stride))
+                return false;
+            size_t ready = std::min(count - item, (size_t)(reader.end - reader.cursor) / stride);
+            char const* record = reader.cursor;
+            for (size_t end = item + ready; item < end; item++, record += stride)
+            {
+                for (int axis = 0; axis < 3; axis++)
+                    memcpy(outPosition + item * 3 + axis, record + offset[axis], sizeof(float));
+                if (hasNormal)
+                    for (int axis = 0; axis < 3; axis++)
+                        memcpy(outNormal + item * 3 + axis, record + offset[3 + axis], sizeof(float));
+                if (hasUV)
+                    for (int axis = 0; axis < 2; axis++)
+                        memcpy(outUV + item * 2 + axis, record + offset[uvField + axis], sizeof(float));
+            }
+            reader.cursor = record;
+        }
+        return true;
+    }
+
+    // Fast path of face element with only uchar count and int or uint index list. Output is written by pointer,
+    // it is sized for triangles and grows only for polygons
+    bool readPlyIndexLists(PlyReader& reader, size_t count, size_t vertexCount, std::vector<uint32_t>& index, size_t& badFaceCount)
+    {
+        size_t used = index.size();
+        index.resize(used + count * 3);
+        uint32_t corners[256];
+        for (size_t item = 0; item < count; item++)
+        {
+            if (!reader.ensure(1))
+                return false;
+            size_t cornerCount = (uint8_t)*reader.cursor;
+            size_t size = 1 + cornerCount * sizeof(uint32_t);
+            if (!reader.ensure(size))
+                return false;
+            memcpy(corners, reader.cursor + 1, cornerCount * sizeof(uint32_t));
+            reader.cursor += size;
+
+            bool isGood = cornerCount >= 3;
+            for (size_t corner = 0; corner < cornerCount; corner++)
+                isGood = isGood && corners[corner] < vertexCount; // negative int is large as uint32_t
+            if (!isGood)
+            {
+                badFaceCount++;
+                continue;
+            }
+
+            size_t needed = used + (cornerCount - 2) * 3;
+            if (needed > index.size())
+                index.resize(std::max(needed, index.size() + index.size() / 2));
+            uint32_t* out = index.data() + used;
+            for (size_t corner = 2; corner < cornerCount; corner++, out += 3)
+            {
+                out[0] = corners[0];
+                out[1] = corners[corner - 1];
+                out[2] = corners[corner];
+            }
+            used = needed;
+        }
+        index.resize(used);
+        return true;
+    }
+
+    // Indexed data of PLY vertex and face elements, polygons are triangulated as fan.
+    // Normal and uv stay empty if vertex has no such properties
+    bool loadPly(std::string const& filePath, std::vector<float>& position, std::vector<float>& normal, std::vector<float>& uv, std::vector<uint32_t>& index)
+    {
+        // Header must fit in first block of compressed file, body is read block by block
+        std::unique_ptr<MappedFile> file;
+        std::unique_ptr<DecompressStream> stream;
+        PlyReader reader;
+        char const* data = nullptr;
+        size_t size = 0;
+        if (DecompressStream::isCompressed(filePath))
+        {
+            stream = std::make_unique<DecompressStream>(Utils::resourceDir + filePath);
+            reader.stream = stream.get();
+            stream->read(reader.buffer);
+            data = reader.buffer.data();
+            size = reader.buffer.size();
+        }
+        else
+        {
+            file = std::make_unique<MappedFile>(Utils::resourceDir + filePath);
+            data = file->data();
+            size = file->size();
+        }
+
+        if (!data || (stream && !stream->isOpen()))
+        {
+            std::cerr << "error load file " + filePath << std::endl;
+            return false;
+        }
+
+        std::vector<PlyElement> elements;
+        if (!parsePlyHeader(data, size, elements, reader))
+        {
+            std::cerr << filePath << ": unsupported PLY header" << std::endl;
+            return false;
+        }
+
+        // Faces are checked against vertices that are read, vertex element without x, y, z is skipped
+        size_t vertexCount = 0;
+        size_t faceCount = 0;
+        for (PlyElement const& element : elements)
+        {
+            if (element.name == "vertex" && element.find({ "x" }) >= 0 && element.find({ "y" }) >= 0 && element.find({ "z" }) >= 0)
+                vertexCount = element.count;
+            if (element.name == "face")
+                faceCount += element.count;
+        }
+        if (faceCount && !vertexCount)
+        {
+            std::cerr << filePath << ": PLY has faces but no vertex positions" << std::endl;
+            return false;
+        }
+
+        std::vector<double> values;
+        std::vector<double> listValues;
+        std::vector<double> polygon;
+        std::vector<size_t> offset;
+        size_t stride = 0;
+        size_t badFaceCount = 0;
+
+        for (PlyElement const& element : elements)
+        {
+            values.resize(element.properties.size());
+            int x = element.find({ "x" }), y = element.find({ "y" }), z = element.find({ "z" });
+            int nx = element.find({ "nx" }), ny = element.find({ "ny" }), nz = element.find({ "nz" });
+            int u = element.find({ "u", "s", "texture_u" }), v = element.find({ "v", "t", "texture_v" });
+            int face = element.find({ "vertex_indices", "vertex_index" });
+            bool isVertex = element.name == "vertex" && x >= 0 && y >= 0 && z >= 0;
+            bool hasNormal = nx >= 0 && ny >= 0 && nz >= 0;
+            bool hasUV = u >= 0 && v >= 0;
+            bool isFace = element.name == "face" && face >= 0 && element.properties[face].countType != PlyType::None;
+
+            if (isVertex)
+            {
+                position.reserve(element.count * 3);
+                normal.reserve(hasNormal ? element.count * 3 : 0);
+                uv.reserve(hasUV ? element.count * 2 : 0);
+            }
+            if (isFace)
+                index.reserve(element.count * 3);
+
+            // Common binary_little_endian layout is read without per value conversion
+            if (isVertex && plyFixedLayout(element, reader, offset, stride))
+            {
+                std::vector<int> fields = { x, y, z };
+                if (hasNormal)
+                    fields.insert(fields.end(), { nx, ny, nz });
+                if (hasUV)
+                    fields.insert(fields.end(), { u, v });
+                std::vector<size_t> fieldOffset;
+                for (int field : fields)
+                    if (element.properties[field].type == PlyType::Float32)
+                        fieldOffset.push_back(offset[field]);
+                if (fieldOffset.size() == fields.size())
+                {
+                    if (!readPlyFloatVertices(reader, element.count, stride, fieldOffset, position, normal, uv))
+                    {
+                        std::cerr << filePath << ": unexpected end of PLY body" << std::endl;
+                        return false;
+                    }
+                    continue;
+                }
+            }
+            PlyProperty const* list = isFace ? &element.properties[face] : nullptr;
+            bool isIntList = list && (list->type == PlyType::Int32 || list->type == PlyType::UInt32);
+            if (isFace && element.properties.size() == 1 && reader.isBinary && !reader.isSwap && list->countType == PlyType::UInt8 && isIntList)
+            {
+                if (!readPlyIndexLists(reader, element.count, vertexCount, index, badFaceCount))
+                {
+                    std::cerr << filePath << ": unexpected end of PLY body" << std::endl;
+                    return false;
+                }
+                continue;
+            }
+
+            for (size_t item = 0; item < element.count; item++)
+            {
+                for (size_t property = 0; property < element.properties.size(); property++)
+                {
+                    bool isIndexList = isFace && (int)property == face;
+                    if (!reader.readProperty(element.properties[property], values[property], isIndexList ? polygon : listValues))
+                    {
+                        std::cerr << filePath << ": unexpected end of PLY body" << std::endl;
+                        return false;
+                    }
+                }
+
+                if (isVertex)
+                {
+                    position.insert(position.end(), { (float)values[x], (float)values[y], (float)values[z] });
+                    if (hasNormal)
+                        normal.insert(normal.end(), { (float)values[nx], (float)values[ny], (float)values[nz] });
+                    if (hasUV)
+                        uv.insert(uv.end(), { (float)values[u], (float)values[v] });
+                }
+
+                if (isFace)
+                {
+                    bool isGood = polygon.size() >= 3;
+                    for (double corner : polygon)
+                        isGood = isGood && corner >= 0.0 && corner < (double)vertexCount;
+                    for (size_t corner = 2; corner < polygon.size() && isGood; corner++)
+                        index.insert(index.end(), { (uint32_t)polygon[0], (uint32_t)polygon[corner - 1], (uint32_t)polygon[corner] });
+                    badFaceCount += !isGood;
+                }
+            }
+        }
+
+        if (stream && !stream->isGood())
+            return false; // worker reported broken or truncated data
+
+        if (badFaceCount)
+            std::cerr << filePath << ": skipped " << badFaceCount << " bad faces" << std::endl;
+        return true;
+    }
+}
+
+void ModelLoader::Ply(std::string const& filePath, std::vector<float>& rawVertex, std::vector<float>& rawNormal, std::vector<float>& rawUV)
+{
+    rawVertex.clear();
+    rawNormal.clear();
+    rawUV.clear();
+
+    std::vector<float> position, normal, uv;
+    std::vector<uint32_t> index;
+    if (!loadPly(filePath, position, normal, uv, index))
+        return;
+
+    rawVertex.reserve(index.size() * 3);
+    rawNormal.reserve(normal.empty() ? 0 : index.size() * 3);
+    rawUV.reserve(uv.empty() ? 0 : index.size() * 2);
+    for (uint32_t vertex : index)
+    {
+        rawVertex.insert(rawVertex.end(), &position[vertex * 3], &position[vertex * 3] + 3);
+        if (!normal.empty())
+            rawNormal.insert(rawNormal.end(), &normal[vertex * 3], &normal[vertex * 3] + 3);
+        if (!uv.empty())
+            rawUV.insert(rawUV.end(), &uv[vertex * 2], &uv[vertex * 2] + 2);
+    }
+}
+
+void ModelLoader::PlyIndexed(std::string const& filePath, IndexedMesh& mesh)
+{
+    mesh = IndexedMesh();
+
+    std::vector<float> position, normal, uv;
+    std::vector<uint32_t> index;
+    if (loadPly(filePath, position, normal, uv, index))
+        mesh.assign(std::move(position), std::move(normal), std::move(uv), std::move(index));
+}
+
+namespace
+{
+    // Mesh primitive placed in world by node hierarchy
+    struct GltfInstance
+    {
+        JsonValue const* primitive;
+        glm::mat4 transform;
+    };
+
+    glm::mat4 gltfNodeTransform(JsonValue const& node)
+    {
+        JsonValue const& matrix = node["matrix"];
+        if (matrix.size() == 16)
+        {
+            float values[16];
+            for (int index = 0; index < 16; index++)
+                values[index] = (float)matrix[index].getNumber();
+            return glm::make_mat4(values); // column major in both
+        }
+
+        JsonValue const& translation = node["translation"];
+        JsonValue const& rotation = node["rotation"]; // x,y,z,w
+        JsonValue const& scale = node["scale"];
+        glm::mat4 transform = glm::translate(glm::mat4(1.0f), glm::vec3(translation[0].getNumber(), translation[1].getNumber(), translation[2].getNumber()));
+        transform = transform * glm::mat4_cast(glm::quat((float)rotation[3].getNumber(1.0), (float)rotation[0].getNumber(), (float)rotation[1].getNumber(), (float)rotation[2].getNumber()));
+        return glm::scale(transform, glm::vec3(scale[0].getNumber(1.0), scale[1].getNumber(1.0), scale[2].getNumber(1.0)));
+    }
+
+    void collectGltfInstances(JsonValue const& json, int nodeIndex, glm::mat4 const& parent, int depth, std::vector<GltfInstance>& instances)
+    {
+        JsonValue const& node = json["nodes"][nodeIndex];
+        if (node.isNull() || depth > 64) // broken file can have cycle
+            return;
+
+        glm::mat4 transform = parent * gltfNodeTransform(node);
+        JsonValue const& primitives = json["meshes"][node["mesh"].getInt(-1)]["primitives"];
+        for (int primitive = 0; primitive < (int)primitives.size(); primitive++)
+            instances.push_back({ &primitives[primitive], transform });
+
+        JsonValue const& children = node["children"];
+        for (int child = 0; child < (int)children.size(); child++)
+            collectGltfInstances(json, children[child].getInt(-1), transform, depth + 1, instances);
+    }
+}
+
+void ModelLoader::Gltf(std::string const& filePath, IndexedMesh& mesh)
+{
+    mesh = IndexedMesh();
+
+    GltfFile gltf(Utils::resourceDir + filePath);
+    if (!gltf.isOpen())
+        return;
+    JsonValue const& json = gltf.getJson();
+
+    // Roots of default scene, file without scenes has every node that is not child as root
+    std::vector<int> roots;
+    JsonValue const& scene = json["scenes"][json["scene"].getInt(0)];
+    if (!scene.isNull())
+    {
+        for (int node = 0; node < (int)scene["nodes"].size(); node++)
+            roots.push_back(scene["nodes"][node].getInt(-1));
+    }
+    else
+    {
+        std::vector<bool> isChild(json["nodes"].size(), false);
+        for (int node = 0; node < (int)json["nodes"].size(); node++)
+            for (int child = 0; child < (int)json["nodes"][node]["children"].size(); child++)
+                if (json["nodes"][node]["children"][child].getInt(-1) >= 0 && json["nodes"][node]["children"][child].getInt(-1) < (int)isChild.size())
+                    isChild[json["nodes"][node]["children"][child].getInt()] = true;
+        for (int node = 0; node < (int)isChild.size(); node++)
+            if (!isChild[node])
+                roots.push_back(node);
+    }
+
+    std::vector<GltfInstance> instances;
+    for (int root : roots)
+        collectGltfInstances(json, root, glm::mat4(1.0f), 0, instances);
+
+    // Views into binary chunk, only triangle lists with float positions are used
+    struct PrimitiveViews
+    {
+        GltfAccessor position, normal, uv, index;
+    };
+    std::vector<PrimitiveViews> views;
+    std::vector<GltfInstance> used;
+    size_t vertexCount = 0, indexCount = 0, skippedCount = 0;
+    bool hasNormal = true, hasUV = true;
+
+    for (GltfInstance const& instance : instances)
+    {
+        JsonValue const& primitive = *instance.primitive;
+        JsonValue const& attributes = primitive["attributes"];
+        PrimitiveViews primitiveViews;
+        primitiveViews.position = gltf.getAccessor(attributes["POSITION"].getInt(-1));
+        primitiveViews.normal = gltf.getAccessor(attributes["NORMAL"].getInt(-1));
+        primitiveViews.uv = gltf.getAccessor(attributes["TEXCOORD_0"].getInt(-1));
+        primitiveViews.index = gltf.getAccessor(primitive["indices"].getInt(-1));
+
+        GltfAccessor const& position = primitiveViews.position;
+        bool isTriangles = primitive["mode"].getInt(4) == 4;
+        if (!isTriangles || !position.isValid() || position.componentType != 5126 || position.componentCount != 3 ||
+            (primitive.has("indices") && (!primitiveViews.index.isValid() || primitiveViews.index.componentCount != 1)))
+        {
+            skippedCount++;
+            continue;
+        }
+
+        hasNormal = hasNormal && primitiveViews.normal.isValid() && primitiveViews.normal.componentCount == 3 && primitiveViews.normal.count == position.count;
+        hasUV = hasUV && primitiveViews.uv.isValid() && primitiveViews.uv.componentCount == 2 && primitiveViews.uv.count == position.count;
+        vertexCount += position.count;
+        indexCount += primitiveViews.index.isValid() ? primitiveViews.index.count : position.count;
+        views.push_back(primitiveViews);
+        used.push_back(instance);
+    }
+
+    // Instances are flattened, BVH has no instance level. Data is read from views once, straight to world space
+    std::vector<float> position, normal, uv;
+    std::vector<uint32_t> index;
+    position.reserve(vertexCount * 3);
+    normal.reserve(hasNormal ? vertexCount * 3 : 0);
+    uv.reserve(hasUV ? vertexCount * 2 : 0);
+    index.reserve(indexCount);
+
+    for (size_t instance = 0; instance < views.size(); instance++)
+    {
+        PrimitiveViews const& view = views[instance];
+        glm::mat4 const& transform = used[instance].transform;
+        glm::mat3 normalTransform = glm::transpose(glm::inverse(glm::mat3(transform)));
+        bool isMirror = glm::determinant(glm::mat3(transform)) < 0.0f; // keep winding for watertight test
+        uint32_t base = (uint32_t)(position.size() / 3);
+
+        for (size_t vertex = 0; vertex < view.position.count; vertex++)
+        {
+            glm::vec4 world = transform * glm::vec4(view.position.getFloat(vertex, 0), view.position.getFloat(vertex, 1), view.position.getFloat(vertex, 2), 1.0f);
+            position.insert(position.end(), { world.x, world.y, world.z });
+
+            if (hasNormal)
+            {
+                glm::vec3 direction = normalTransform * glm::vec3(view.normal.getFloat(vertex, 0), view.normal.getFloat(vertex, 1), view.normal.getFloat(vertex, 2));
+                direction = glm::length(direction) > 0.0f ? glm::normalize(direction) : direction;
+                normal.insert(normal.end(), { direction.x, direction.y, direction.z });
+            }
+
+            if (hasUV)
+                uv.insert(uv.end(), { view.uv.getFloat(vertex, 0), 1.0f - view.uv.getFloat(vertex, 1) }); // glTF v goes down, OBJ v goes up
+        }
+
+        size_t cornerCount = view.index.isValid() ? view.index.count : view.position.count;
+        for (size_t corner = 0; corner + 2 < cornerCount; corner += 3)
+        {
+            uint32_t triangle[3];
+            bool isGood = true;
+            for (int vertex = 0; vertex < 3; vertex++)
+            {
+                triangle[vertex] = view.index.isValid() ? view.index.getIndex(corner + vertex) : (uint32_t)(corner + vertex);
+                isGood = isGood && triangle[vertex] < view.position.count;
+            }
+            if (!isGood)
+            {
+                skippedCount++;
+                continue;
+            }
+            if (isMirror)
+                std::swap(triangle[1], triangle[2]);
+            index.insert(index.end(), { base + triangle[0], base + triangle[1], base + triangle[2] });
+        }
+    }
+
+    mesh.assign(std::move(position), std::move(normal), std::move(uv), std::move(index));
+
+    if (skippedCount)
+        std::cerr << filePath << ": skipped " << skippedCount << " unsupported primitives or triangles" << std::endl;
+}
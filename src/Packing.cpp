@@ -0,0 +1,93 @@
+#include <glm.hpp>
+#include <cstring>
+#include "Packing.h"
+
+using glm::vec2;
+using glm::vec3;
+
+uint16_t Packing::floatToHalf(float value)
+{
+	uint32_t bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	uint32_t sign = (bits >> 16) & 0x8000;
+	uint32_t floatExponent = (bits >> 23) & 0xFF;
+	int32_t exponent = (int32_t)floatExponent - 127 + 15;
+	uint32_t mantissa = bits & 0x7FFFFF;
+
+	if (floatExponent == 0xFF) // inf, nan
+		return (uint16_t)(sign | 0x7C00 | (mantissa ? 0x200 : 0));
+	if (exponent >= 31) // too big
+		return (uint16_t)(sign | 0x7C00);
+
+	if (exponent <= 0) // subnormal half
+	{
+		if (exponent < -10)
+			return (uint16_t)sign;
+		mantissa |= 0x800000;
+		uint32_t shift = 14 - exponent;
+		uint32_t half = mantissa >> shift;
+		if ((mantissa >> (shift - 1)) & 1)
+			half++;
+		return (uint16_t)(sign | half);
+	}
+
+	// Rounding carry may go to exponent, it is still right value
+	uint32_t half = sign | ((uint32_t)exponent << 10) | (mantissa >> 13);
+	if (mantissa & 0x1000)
+		half++;
+	return (uint16_t)half;
+}
+
+float Packing::halfToFloat(uint16_t half)
+{
+	uint32_t sign = (uint32_t)(half & 0x8000) << 16;
+	uint32_t exponent = (half >> 10) & 0x1F;
+	uint32_t mantissa = half & 0x3FF;
+
+	if (exponent == 0)
+	{
+		float value = mantissa / 16777216.0f; // 2^-24
+		return sign ? -value : value;
+	}
+
+	uint32_t bits = sign | (mantissa << 13);
+	bits |= exponent == 31 ? 0x7F800000 : (exponent - 15 + 127) << 23;
+	float value;
+	std::memcpy(&value, &bits, sizeof(value));
+	return value;
+}
+
+glm::vec2 Packing::octEncode(glm::vec3 const& normal)
+{
+	vec3 n = normal / (glm::abs(normal.x) + glm::abs(normal.y) + glm::abs(normal.z));
+	if (n.z >= 0.0f)
+		return vec2(n.x, n.y);
+
+	return vec2(
+		(1.0f - glm::abs(n.y)) * (n.x >= 0.0f ? 1.0f : -1.0f),
+		(1.0f - glm::abs(n.x)) * (n.y >= 0.0f ? 1.0f : -1.0f));
+}
+
+glm::vec3 Packing::octDecode(glm::vec2 const& encoded)
+{
+	vec3 n(encoded.x, encoded.y, 1.0f - glm::abs(encoded.x) - glm::abs(encoded.y));
+	if (n.z < 0.0f)
+	{
+		float x = n.x;
+		n.x = (1.0f - glm::abs(n.y)) * (x >= 0.0f ? 1.0f : -1.0f);
+		n.y = (1.0f - glm::abs(x)) * (n.y >= 0.0f ? 1.0f : -1.0f);
+	}
+	return glm::normalize(n);
+}
+
+uint32_t Packing::packSnorm2x16(glm::vec2 const& value)
+{
+	vec2 scaled = glm::round(glm::clamp(value, -1.0f, 1.0f) * 32767.0f);
+	return (uint32_t)(uint16_t)(int16_t)scaled.x | ((uint32_t)(uint16_t)(int16_t)scaled.y << 16);
+}
+
+glm::vec2 Packing::unpackSnorm2x16(uint32_t packed)
+{
+	vec2 value((int16_t)(packed & 0xFFFF), (int16_t)(packed >> 16));
+	return glm::clamp(value / 32767.0f, -1.0f, 1.0f);
+}
@@ -0,0 +1,105 @@
+#include <glm.hpp>
+#include <algorithm>
+#include "RayStream.h"
+#include "BVHBuilder.h"
+#include "ThreadPool.h"
+#include "Ray.h"
+
+using glm::vec3;
+
+namespace
+{
+	constexpr int RaysInTask = 1024;
+
+	// 10 bit value to 30 bit, two zero bits between each bit
+	uint32_t expandBits(uint32_t value)
+	{
+		value = (value * 0x00010001u) & 0xFF0000FFu;
+		value = (value * 0x00000101u) & 0x0F00F00Fu;
+		value = (value * 0x00000011u) & 0xC30C30C3u;
+		value = (value * 0x00000005u) & 0x49249249u;
+		return value;
+	}
+
+	uint32_t morton3D(vec3 const& point)
+	{
+		vec3 cell = glm::clamp(point * 1024.0f, 0.0f, 1023.0f);
+		return (expandBits((uint32_t)cell.x) << 2) | (expandBits((uint32_t)cell.y) << 1) | expandBits((uint32_t)cell.z);
+	}
+}
+
+uint32_t RayStream::sortKey(Ray const& ray, glm::vec3 const& boundsMin, glm::vec3 const& boundsMax)
+{
+	uint32_t octant = (ray.direction.x < 0.0f ? 1 : 0) | (ray.direction.y < 0.0f ? 2 : 0) | (ray.direction.z < 0.0f ? 4 : 0);
+	vec3 extent = glm::max(boundsMax - boundsMin, vec3(1e-6f));
+	uint32_t morton = morton3D((ray.origin - boundsMin) / extent);
+	return (octant << 29) | (morton >> 1);
+}
+
+void RayStream::sortOrder(std::vector<Ray> const& rays, glm::vec3 const& boundsMin, glm::vec3 const& boundsMax, std::vector<uint32_t>& order)
+{
+	size_t count = rays.size();
+	std::vector<uint32_t> keys(count);
+	std::vector<uint32_t> tempKeys(count);
+	std::vector<uint32_t> tempOrder(count);
+	order.resize(count);
+
+	for (size_t index = 0; index < count; index++)
+	{
+		keys[index] = sortKey(rays[index], boundsMin, boundsMax);
+		order[index] = (uint32_t)index;
+	}
+
+	// LSD radix sort, 8 bit digit per pass, stable so equal keys keep input order
+	for (int shift = 0; shift < 32; shift += 8)
+	{
+		size_t offsets[256] = {};
+		for (uint32_t key : keys)
+			offsets[(key >> shift) & 0xFF]++;
+
+		size_t sum = 0;
+		for (size_t& offset : offsets)
+		{
+			size_t digitCount = offset;
+			offset = sum;
+			sum += digitCount;
+		}
+
+		for (size_t index = 0; index < count; index++)
+		{
+			size_t target = offsets[(keys[index] >> shift) & 0xFF]++;
+			tempKeys[target] = keys[index];
+			tempOrder[target] = order[index];
+		}
+		keys.swap(tempKeys);
+		order.swap(tempOrder);
+	}
+}
+
+void RayStream::traceCloseHit(BVHBuilder const& bvh, ThreadPool& pool, std::vector<Ray> const& rays, std::vector<Hit>& hits, bool reorder)
+{
+	hits.resize(rays.size());
+
+	std::vector<uint32_t> order;
+	if (reorder)
+	{
+		vec3 boundsMin, boundsMax;
+		bvh.getBounds(boundsMin, boundsMax);
+		sortOrder(rays, boundsMin, boundsMax, order);
+	}
+
+	int taskCount = (int)((rays.size() + RaysInTask - 1) / RaysInTask);
+	pool.parallelFor(taskCount, [&bvh, &rays, &hits, &order, reorder](int taskIndex)
+	{
+		size_t start = (size_t)taskIndex * RaysInTask;
+		size_t end = std::min(start + RaysInTask, rays.size());
+		for (size_t index = start; index < end; index++)
+		{
+			size_t rayIndex = reorder ? order[index] : index;
+			Ray ray = rays[rayIndex];
+			Hit& hit = hits[rayIndex];
+			hit.normal = vec3(0.0f);
+			bvh.traceCloseHit(ray, hit);
+		}
+	});
+}
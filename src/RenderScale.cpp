@@ -0,0 +1,39 @@
+#include "RenderScale.h"
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+	constexpr float Damping = 0.25f;     // part of wanted change done per measurement
+	constexpr float MinChange = 0.01f;   // closer to wanted scale keeps current one
+	constexpr float MaxStepRatio = 2.0f; // one measurement change area at most this much
+}
+
+RenderScale::RenderScale(double budgetMilliseconds, float minScale, float maxScale) :
+	budget(budgetMilliseconds), minScale(minScale), maxScale(maxScale), scale(maxScale) {}
+
+void RenderScale::update(double gpuMilliseconds)
+{
+	if (std::isnan(gpuMilliseconds) || gpuMilliseconds <= 0.0)
+		return;
+
+	float areaRatio = std::clamp((float)(budget / gpuMilliseconds), 1.0f / MaxStepRatio, MaxStepRatio);
+	float wanted = std::clamp(scale * std::sqrt(areaRatio), minScale, maxScale);
+	if (std::abs(wanted - scale) < MinChange)
+		return;
+
+	float next = scale + (wanted - scale) * Damping;
+	if (std::abs(wanted - next) < MinChange)
+		next = wanted;
+	scale = next;
+}
+
+float RenderScale::getScale() const
+{
+	return scale;
+}
+
+int RenderScale::scaled(int size) const
+{
+	return std::max(1, (int)std::lround(size * scale));
+}
@@ -0,0 +1,70 @@
+#include "RenderTargetGL.h"
+#include "glad.h" // Opengl function loader
+#include <iostream>
+
+RenderTargetGL::RenderTargetGL(int width, int height, std::vector<uint32_t> const& colorFormats) : framebufferID(0), textureIDs(colorFormats.size()), width(width), height(height)
+{
+	glGenFramebuffers(1, &framebufferID);
+	glBindFramebuffer(GL_FRAMEBUFFER, framebufferID);
+	glGenTextures((int)textureIDs.size(), textureIDs.data());
+	std::vector<GLenum> drawBuffers;
+	for (size_t attachment = 0; attachment < textureIDs.size(); attachment++)
+	{
+		glBindTexture(GL_TEXTURE_2D, textureIDs[attachment]);
+		glTexImage2D(GL_TEXTURE_2D, 0, colorFormats[attachment], width, height, 0, GL_RGBA, GL_FLOAT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0 + (GLenum)attachment, GL_TEXTURE_2D, textureIDs[attachment], 0);
+		drawBuffers.push_back(GL_COLOR_ATTACHMENT0 + (GLenum)attachment);
+	}
+	glDrawBuffers((int)drawBuffers.size(), drawBuffers.data());
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+		std::cerr << "Render target " << width << "x" << height << " is not complete" << std::endl;
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+RenderTargetGL::~RenderTargetGL()
+{
+	glDeleteFramebuffers(1, &framebufferID);
+	glDeleteTextures((int)textureIDs.size(), textureIDs.data());
+}
+
+void RenderTargetGL::bind()
+{
+	bind(width, height);
+}
+
+void RenderTargetGL::bind(int viewportWidth, int viewportHeight)
+{
+	glBindFramebuffer(GL_FRAMEBUFFER, framebufferID);
+	glViewport(0, 0, viewportWidth, viewportHeight);
+}
+
+void RenderTargetGL::blitToScreen(int screenWidth, int screenHeight) const
+{
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, framebufferID);
+	glReadBuffer(GL_COLOR_ATTACHMENT0);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, 0);
+	glBlitFramebuffer(0, 0, width, height, 0, 0, screenWidth, screenHeight, GL_COLOR_BUFFER_BIT, GL_LINEAR);
+	glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+uint32_t RenderTargetGL::getTextureID(int attachment) const
+{
+	return textureIDs[attachment];
+}
+
+int RenderTargetGL::getWidth() const
+{
+	return width;
+}
+
+int RenderTargetGL::getHeight() const
+{
+	return height;
+}
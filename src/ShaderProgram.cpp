@@ -2,26 +2,133 @@
 #include <array>
 #include <iostream>
 #include <tuple>
+#include <vector>
+#include <cstring>
+#include <cstdio>
+#include <sstream>
 #include <glm.hpp>
 #include "glad.h" // Opengl function
 #include "Utils.h"
 #include "ShaderProgram.h"
 
-ShaderProgram::ShaderProgram(std::string const& vertexShaderPath, std::string const& fragmentShaderPath): programID(-1), texUnitSlotIndex(0)
+namespace
+{
+	// FNV-1a, only for cache file name
+	uint64_t hashText(uint64_t hash, char const* text, size_t size)
+	{
+		for (size_t index = 0; index < size; index++)
+			hash = (hash ^ (unsigned char)text[index]) * 1099511628211ull;
+		return hash;
+	}
+
+	uint64_t hashText(uint64_t hash, char const* text)
+	{
+		return hashText(hash, text, text ? strlen(text) : 0);
+	}
+}
+
+ShaderProgram::ShaderProgram(std::string const& vertexShaderPath, std::string const& fragmentShaderPath, ShaderDefines const& defines): programID(-1), texUnitSlotIndex(0)
 {
 	using std::make_tuple;
 	using shader = std::tuple<std::string, int, unsigned int>; // <shader source code, shader type, shader id>
     
-	std::array<shader, 2> shaderCode {
-        make_tuple(loadShaderByFile(Utils::resourceDir + vertexShaderPath), GL_VERTEX_SHADER, 0),
-        make_tuple(loadShaderByFile(Utils::resourceDir + fragmentShaderPath), GL_FRAGMENT_SHADER, 0) };
+	std::string vertexSource = preprocess(vertexShaderPath);
+	std::array<int, 2> fileNumbers{ 0, (int)sourceFiles.size() };
+	ShaderCode shaderCode {
+        make_tuple(vertexSource, GL_VERTEX_SHADER, 0),
+        make_tuple(preprocess(fragmentShaderPath), GL_FRAGMENT_SHADER, 0) };
+
+    // Defines go after #version, which must be the first line, #line keep numbers of file
+    std::string defineLines;
+    for (auto const& [name, value] : defines)
+        defineLines += "#define " + name + " " + value + "\n";
+    for (int index = 0; index < 2; index++)
+    {
+        std::string& sourceCode = std::get<0>(shaderCode[index]);
+        size_t versionEnd = sourceCode.find('\n') + 1;
+        sourceCode.insert(versionEnd, defineLines + "#line 2 " + std::to_string(fileNumbers[index]) + "\n");
+    }
+
+    // Binary is valid only for same sources (defines are inside) and same driver
+    uint64_t hash = 14695981039104346037ull;
+    for (shader& shaderItem : shaderCode)
+        hash = hashText(hash, std::get<0>(shaderItem).data(), std::get<0>(shaderItem).size());
+    hash = hashText(hash, (char const*)glGetString(GL_VENDOR));
+    hash = hashText(hash, (char const*)glGetString(GL_RENDERER));
+    hash = hashText(hash, (char const*)glGetString(GL_VERSION));
+    char cacheName[32];
+    snprintf(cacheName, sizeof(cacheName), "cache_%016llx.bin", (unsigned long long)hash);
+    std::string cachePath = Utils::resourceDir + std::string("shaders/") + cacheName;
+
+    programID = glCreateProgram();
+    bool isCached = isBinarySupported() && loadBinary(cachePath);
+    if (!isCached)
+    {
+        compileProgram(shaderCode);
+        if (isBinarySupported())
+            saveBinary(cachePath);
+    }
+
+    reflectUniforms();
+}
+
+bool ShaderProgram::isBinarySupported()
+{
+    if (!glProgramBinary || !glGetProgramBinary)
+        return false;
+    int formatCount = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+    return formatCount > 0;
+}
+
+// File: binary format then program binary. Driver may reject it after update, then program is compiled again
+bool ShaderProgram::loadBinary(std::string const& path)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file.is_open())
+        return false;
+
+    uint32_t format = 0;
+    file.read((char*)&format, sizeof(format));
+    std::vector<char> binary((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    if (!file.good() && !file.eof())
+        return false;
+
+    int success = 0;
+    glProgramBinary(programID, format, binary.data(), (int)binary.size());
+    glGetProgramiv(programID, GL_LINK_STATUS, &success);
+    if (!success)
+        std::cout << "Shader cache " << path << " rejected by driver, compile shaders" << std::endl;
+    return success;
+}
+
+void ShaderProgram::saveBinary(std::string const& path)
+{
+    int length = 0;
+    glGetProgramiv(programID, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0)
+        return;
+
+    uint32_t format = 0;
+    std::vector<char> binary(length);
+    glGetProgramBinary(programID, length, &length, &format, binary.data());
+    std::ofstream file(path, std::ios::binary);
+    file.write((char const*)&format, sizeof(format));
+    file.write(binary.data(), length);
+    if (!file.good())
+        std::cerr << "Failed write shader cache " << path << std::endl;
+}
+
+void ShaderProgram::compileProgram(ShaderCode& shaderCode)
+{
+    using shader = std::tuple<std::string, int, unsigned int>;
 
     // For check error
     int  success;
     char infoLog[512];
     for (shader& shaderItem : shaderCode)
     {
-        auto& [sourceCode, shaderType, shaderID] = shaderItem;   
+        auto& [sourceCode, shaderType, shaderID] = shaderItem;
         shaderID = glCreateShader(shaderType);
         const char* sourceCodeData = sourceCode.data();
         glShaderSource(shaderID, 1, &sourceCodeData, NULL);
@@ -32,16 +139,17 @@ ShaderProgram::ShaderProgram(std::string const& vertexShaderPath, std::string co
         {
             glGetShaderInfoLog(shaderID, 512, NULL, infoLog);
             std::cerr << "Error shader compilation failed:\n" << infoLog << std::endl;
+            for (size_t file = 0; file < sourceFiles.size(); file++)
+                std::cerr << "Source " << file << ": " << sourceFiles[file] << std::endl;
         }
     }
-    // Create program
-    programID = glCreateProgram();
-
     for (shader& shaderItem : shaderCode)
         glAttachShader(programID, std::get<2>(shaderItem));
 
+    if (isBinarySupported())
+        glProgramParameteri(programID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glLinkProgram(programID);
-    glGetProgramiv(programID, GL_COMPILE_STATUS, &success);
+    glGetProgramiv(programID, GL_LINK_STATUS, &success);
 
     if (!success)
     {
@@ -50,7 +158,62 @@ ShaderProgram::ShaderProgram(std::string const& vertexShaderPath, std::string co
     }
 
     for (shader& shaderItem : shaderCode)
+    {
+        glDetachShader(programID, std::get<2>(shaderItem));
         glDeleteShader(std::get<2>(shaderItem));
+    }
+}
+
+void ShaderProgram::reflectUniforms()
+{
+    int count = 0;
+    int maxLength = 0;
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+    std::vector<char> name(maxLength + 1);
+    for (int index = 0; index < count; index++)
+    {
+        int size;
+        uint32_t type;
+        glGetActiveUniform(programID, index, (int)name.size(), nullptr, &size, &type, name.data());
+        int location = glGetUniformLocation(programID, name.data());
+        if (location < 0)
+            continue; // member of uniform block
+
+        std::string uniformName(name.data());
+        if (uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0)
+            uniformName.resize(uniformName.size() - 3); // array is set by its name
+        uniforms[uniformName].location = location;
+    }
+
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORM_BLOCKS, &count);
+    glGetProgramiv(programID, GL_ACTIVE_UNIFORM_BLOCK_MAX_NAME_LENGTH, &maxLength);
+    name.resize(maxLength + 1);
+    for (int index = 0; index < count; index++)
+    {
+        glGetActiveUniformBlockName(programID, index, (int)name.size(), nullptr, name.data());
+        uniformBlocks[name.data()].index = index;
+    }
+}
+
+int ShaderProgram::findLocation(std::string const& name) const
+{
+    auto found = uniforms.find(name);
+    return found != uniforms.end() ? found->second.location : -1;
+}
+
+int ShaderProgram::changedLocation(std::string const& name, void const* data, size_t size)
+{
+    auto found = uniforms.find(name);
+    if (found == uniforms.end())
+        return -1;
+
+    Uniform& uniform = found->second;
+    if (uniform.size == size && memcmp(uniform.value.data(), data, size) == 0)
+        return -1;
+    uniform.size = size;
+    memcpy(uniform.value.data(), data, size);
+    return uniform.location;
 }
 
 std::string ShaderProgram::loadShaderByFile(std::string const& shaderPath)
@@ -61,6 +224,41 @@ std::string ShaderProgram::loadShaderByFile(std::string const& shaderPath)
 	return shaderSource;
 }
 
+// Line "#include "file"" is replaced by file text between #line, so compile log point to file and line.
+// File guard is #ifndef inside file, depth only stop include cycle
+std::string ShaderProgram::preprocess(std::string const& shaderPath, int depth)
+{
+    int fileNumber = (int)sourceFiles.size();
+    sourceFiles.push_back(shaderPath);
+    std::string directory = shaderPath.substr(0, shaderPath.find_last_of('/') + 1);
+    std::istringstream source(loadShaderByFile(Utils::resourceDir + shaderPath));
+    std::string result;
+    std::string line;
+    int lineNumber = 0;
+    while (std::getline(source, line))
+    {
+        lineNumber++;
+        size_t start = line.find_first_not_of(" \t");
+        if (start == std::string::npos || line.compare(start, 8, "#include") != 0)
+        {
+            result += line + "\n";
+            continue;
+        }
+
+        size_t open = line.find('"', start);
+        size_t close = open == std::string::npos ? open : line.find('"', open + 1);
+        if (close == std::string::npos || depth >= 16)
+        {
+            std::cerr << shaderPath << ":" << lineNumber << ": bad #include or include cycle" << std::endl;
+            continue;
+        }
+        result += "#line 1 " + std::to_string(sourceFiles.size()) + "\n";
+        result += preprocess(directory + line.substr(open + 1, close - open - 1), depth + 1);
+        result += "#line " + std::to_string(lineNumber + 1) + " " + std::to_string(fileNumber) + "\n";
+    }
+    return result;
+}
+
 void ShaderProgram::bind()
 {
     glUseProgram(programID);
@@ -71,42 +269,65 @@ void ShaderProgram::setTexture(std::string const& textureName, uint32_t texID, i
 {
     glActiveTexture(GL_TEXTURE0 + texUnitSlot);
     glBindTexture(GL_TEXTURE_2D, texID);
-    uint32_t textureLocation = glGetUniformLocation(programID, textureName.data());
-    glUniform1i(textureLocation, texUnitSlot);
+    setInt(textureName, texUnitSlot);
 }
 
 void ShaderProgram::setTextureAI(std::string const& textureName, TextureGL const& texture)
 {
     glActiveTexture(GL_TEXTURE0 + texUnitSlotIndex);
-    glBindTexture(GL_TEXTURE_2D, texture.textureID);
-    uint32_t textureLocation = glGetUniformLocation(programID, textureName.data());
-    glUniform1i(textureLocation, texUnitSlotIndex);
+    glBindTexture(texture.target, texture.textureID);
+    setInt(textureName, texUnitSlotIndex);
 
     texUnitSlotIndex++;
 }
 
 void ShaderProgram::setMatrix3x3(std::string const& matrixName, glm::mat3 const& matrix, int count, bool transpose)
 {
-    uint32_t matrixLocation = glGetUniformLocation(programID, matrixName.data());
-    glUniformMatrix3fv(matrixLocation, count, transpose, &matrix[0][0]);
+    int matrixLocation = count == 1 && !transpose ? changedLocation(matrixName, &matrix[0][0], sizeof(glm::mat3)) : findLocation(matrixName);
+    if (matrixLocation >= 0)
+        glUniformMatrix3fv(matrixLocation, count, transpose, &matrix[0][0]);
 }
 
 void ShaderProgram::setVec3(std::string const& vectorName, glm::vec3 const& vector)
 {
-    uint32_t vecLocation = glGetUniformLocation(programID, vectorName.data());
-    glUniform3f(vecLocation, vector.x, vector.y, vector.z);
+    int vecLocation = changedLocation(vectorName, &vector.x, sizeof(glm::vec3));
+    if (vecLocation >= 0)
+        glUniform3f(vecLocation, vector.x, vector.y, vector.z);
 }
 
 void ShaderProgram::setVec2(std::string const& vectorName, glm::vec2 const& vector)
 {
-    uint32_t vecLocation = glGetUniformLocation(programID, vectorName.data());
-    glUniform2f(vecLocation, vector.x, vector.y);
+    int vecLocation = changedLocation(vectorName, &vector.x, sizeof(glm::vec2));
+    if (vecLocation >= 0)
+        glUniform2f(vecLocation, vector.x, vector.y);
+}
+
+void ShaderProgram::setIVec2(std::string const& vectorName, glm::ivec2 const& vector)
+{
+    int vecLocation = changedLocation(vectorName, &vector.x, sizeof(glm::ivec2));
+    if (vecLocation >= 0)
+        glUniform2i(vecLocation, vector.x, vector.y);
 }
 
 void ShaderProgram::setInt(std::string const& intName, int data)
 {
-    uint32_t intLocation = glGetUniformLocation(programID, intName.data());
-    glUniform1i(intLocation, data);
+    int intLocation = changedLocation(intName, &data, sizeof(int));
+    if (intLocation >= 0)
+        glUniform1i(intLocation, data);
+}
+
+void ShaderProgram::setUniformBlock(std::string const& blockName, UniformBufferGL const& buffer, int bindingPoint)
+{
+    auto found = uniformBlocks.find(blockName);
+    if (found == uniformBlocks.end())
+        return;
+
+    if (found->second.bindingPoint != bindingPoint)
+    {
+        glUniformBlockBinding(programID, found->second.index, bindingPoint);
+        found->second.bindingPoint = bindingPoint;
+    }
+    buffer.bind(bindingPoint);
 }
 
 int ShaderProgram::getID()
@@ -1,19 +1,59 @@
 #include "TextureGL.h"
 #include "glad.h" // Opengl function loader
+#include "Utils.h"
+#include <algorithm>
 #include <iostream>
+#include <cstring>
 
-TextureGL::TextureGL(int width, int height, TextureGLType datatype, const void* data):width(width), height(height)
+namespace
 {
+	struct TexelFormat
+	{
+		uint32_t internalFormat;
+		uint32_t format;
+		uint32_t type;
+		size_t size;
+	};
+
+	TexelFormat getTexelFormat(TextureGLType datatype)
+	{
+		switch (datatype)
+		{
+		case TextureGLType::VertexDataHalf4: return { GL_RGBA16F, GL_RGBA, GL_HALF_FLOAT, 4 * sizeof(uint16_t) };
+		case TextureGLType::IndexUint3: return { GL_RGB32UI, GL_RGB_INTEGER, GL_UNSIGNED_INT, 3 * sizeof(uint32_t) };
+		case TextureGLType::NodeUint4: return { GL_RGBA32UI, GL_RGBA_INTEGER, GL_UNSIGNED_INT, 4 * sizeof(uint32_t) };
+		default: return { GL_RGB32F, GL_RGB, GL_FLOAT, 3 * sizeof(float) };
+		}
+	}
+}
+
+TextureGL::TextureGL(TextureGLType datatype, TextureGLStorage storage, int texelCount, const void* data) :
+	width(texelCount), height(1), layers(1), widthShift(0), layerShift(0), bufferID(0), target(GL_TEXTURE_2D_ARRAY)
+{
+	TexelFormat texel = getTexelFormat(datatype);
+	texelSize = texel.size;
+
 	glGenTextures(1, &textureID);
-	if (datatype == TextureGLType::VertexDataXYZ)
-		VertexDataXYZToTexture(width, height, data);
+	if (storage == TextureGLStorage::Array2D)
+		ArrayToTexture(texelCount, texel.internalFormat, texel.format, texel.type, data);
+
+	if (storage == TextureGLStorage::Buffer)
+		BufferToTexture(texelCount, texel.internalFormat, data);
 }
 
 TextureGL::TextureGL(TextureGL&& other)
 {
-	other.textureID = this->textureID;
-	other.width = this->width;
-	other.height = this->height;
+	this->textureID = other.textureID;
+	this->bufferID = other.bufferID;
+	this->target = other.target;
+	this->texelSize = other.texelSize;
+	this->width = other.width;
+	this->height = other.height;
+	this->layers = other.layers;
+	this->widthShift = other.widthShift;
+	this->layerShift = other.layerShift;
+	other.textureID = 0; // glDeleteTextures ignore 0
+	other.bufferID = 0;
 }
 
 int TextureGL::getWidth()
@@ -26,28 +66,125 @@ int TextureGL::getHeight()
 	return height;
 }
 
+int TextureGL::getLayers()
+{
+	return layers;
+}
+
+int TextureGL::getWidthShift() const
+{
+	return widthShift;
+}
+
+int TextureGL::getLayerShift() const
+{
+	return layerShift;
+}
+
+size_t TextureGL::getMemorySize() const
+{
+	return (size_t)width * height * layers * texelSize;
+}
+
 void TextureGL::bind()
 {
-	glBindTexture(GL_TEXTURE_2D, textureID);
+	glBindTexture(target, textureID);
 }
 
 TextureGL::~TextureGL()
 {
 	glDeleteTextures(1, &textureID);
+	glDeleteBuffers(1, &bufferID);
+}
+
+bool TextureGL::isBufferSupported(int texelCount)
+{
+	int maxSize = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxSize);
+	if (texelCount > maxSize)
+		return false;
+
+	int major = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &major);
+	if (major >= 4)
+		return true;
+
+	int extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+	for (int index = 0; index < extensionCount; index++)
+		if (strcmp((char const*)glGetStringi(GL_EXTENSIONS, index), "GL_ARB_texture_buffer_object_rgb32") == 0)
+			return true;
+	return false;
+}
+
+// Layer has power of two rows so shader finds it by shift. One layer keep only the rows data need.
+// Storage is allocated empty and filled by full rows then the rest, so data need no padding
+void TextureGL::ArrayToTexture(int texelCount, uint32_t internalFormat, uint32_t format, uint32_t type, const void* data)
+{
+	int maxSize = 0;
+	int maxLayers = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_SIZE, &maxSize);
+	glGetIntegerv(GL_MAX_ARRAY_TEXTURE_LAYERS, &maxLayers);
+	int maxRows = Utils::powerOfTwo(maxSize);
+	if (maxRows > maxSize)
+		maxRows /= 2;
+
+	Utils::dataTextureSize(texelCount, width, height);
+	if (width > maxRows)
+	{
+		width = maxRows;
+		height = (texelCount + width - 1) / width;
+	}
+	widthShift = Utils::log2PowerOfTwo(width);
+	layerShift = widthShift + Utils::log2PowerOfTwo(Utils::powerOfTwo(std::min(height, maxRows)));
+	if (height > maxRows)
+	{
+		layers = (height + maxRows - 1) / maxRows;
+		height = maxRows;
+	}
+	if (layers > maxLayers)
+		std::cerr << texelCount << " texels need " << layers << " texture layers, GPU has " << maxLayers << std::endl;
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, textureID);
+	glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, internalFormat, width, height, layers, 0, format, type, nullptr);
+	int layerSize = width * height;
+	for (int layer = 0; layer < layers; layer++)
+	{
+		int layerTexels = std::min(texelCount - layer * layerSize, layerSize);
+		char const* layerData = (char const*)data + (size_t)layer * layerSize * texelSize;
+		int fullRows = layerTexels / width;
+		int rest = layerTexels % width;
+		if (fullRows > 0)
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, layer, width, fullRows, 1, format, type, layerData);
+		if (rest > 0)
+			glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, fullRows, layer, rest, 1, 1, format, type, layerData + (size_t)fullRows * width * texelSize);
+	}
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+
+	int error = glGetError();
+	if (error)
+		std::cerr << error << std::endl;
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
 }
 
-void TextureGL::VertexDataXYZToTexture(int width, int height, const void* data)
+// Linear storage without padding, shader reads it with texelFetch(samplerBuffer, index)
+void TextureGL::BufferToTexture(int texelCount, uint32_t internalFormat, const void* data)
 {
-	glBindTexture(GL_TEXTURE_2D, textureID);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB32F, width, height, 0, GL_RGB, GL_FLOAT, data);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	this->target = GL_TEXTURE_BUFFER;
+	glGenBuffers(1, &bufferID);
+	glBindBuffer(GL_TEXTURE_BUFFER, bufferID);
+	glBufferData(GL_TEXTURE_BUFFER, texelCount * texelSize, data, GL_STATIC_DRAW);
+	glBindTexture(GL_TEXTURE_BUFFER, textureID);
+	glTexBuffer(GL_TEXTURE_BUFFER, internalFormat, bufferID);
 
 	int error = glGetError();
 	if (error)
 		std::cerr << error << std::endl;
 
-	glBindTexture(GL_TEXTURE_2D, 0);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
 }
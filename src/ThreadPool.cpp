@@ -0,0 +1,128 @@
+#include <algorithm>
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(unsigned threadCount) : queuedTasks(0), unfinishedTasks(0), nextQueue(0), stop(false)
+{
+	threadCount = std::max(threadCount, 1u);
+
+	// Extra last queue is the slot of the thread calling wait(), it stays empty and only steals
+	for (unsigned index = 0; index < threadCount + 1; index++)
+		queues.push_back(std::make_unique<WorkQueue>());
+
+	for (unsigned index = 0; index < threadCount; index++)
+		workers.emplace_back(&ThreadPool::workerLoop, this, index);
+}
+
+ThreadPool::~ThreadPool()
+{
+	wait();
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		stop = true;
+	}
+	wakeCondition.notify_all();
+
+	for (std::thread& worker : workers)
+		worker.join();
+}
+
+void ThreadPool::submit(std::function<void()> task)
+{
+	unfinishedTasks++;
+	WorkQueue& queue = *queues[nextQueue++ % workers.size()];
+	{
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		queue.tasks.push_back(std::move(task));
+	}
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		queuedTasks++;
+	}
+	wakeCondition.notify_one();
+}
+
+void ThreadPool::wait()
+{
+	unsigned callerIndex = (unsigned)workers.size();
+	std::function<void()> task;
+
+	while (unfinishedTasks > 0)
+	{
+		if (popTask(callerIndex, task))
+		{
+			task();
+			finishTask();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(wakeMutex);
+		doneCondition.wait(lock, [this] { return unfinishedTasks == 0 || queuedTasks > 0; });
+	}
+}
+
+void ThreadPool::parallelFor(int count, std::function<void(int)> const& task)
+{
+	for (int index = 0; index < count; index++)
+		submit([&task, index] { task(index); });
+	wait();
+}
+
+unsigned ThreadPool::getThreadCount() const
+{
+	return (unsigned)workers.size();
+}
+
+void ThreadPool::workerLoop(unsigned workerIndex)
+{
+	std::function<void()> task;
+	while (true)
+	{
+		if (popTask(workerIndex, task))
+		{
+			task();
+			finishTask();
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(wakeMutex);
+		wakeCondition.wait(lock, [this] { return stop || queuedTasks > 0; });
+		if (stop && queuedTasks == 0)
+			return;
+	}
+}
+
+bool ThreadPool::popTask(unsigned workerIndex, std::function<void()>& task)
+{
+	size_t queueCount = queues.size();
+	for (size_t offset = 0; offset < queueCount; offset++)
+	{
+		WorkQueue& queue = *queues[(workerIndex + offset) % queueCount];
+		std::lock_guard<std::mutex> lock(queue.mutex);
+		if (queue.tasks.empty())
+			continue;
+
+		// Own queue as stack for cache locality, steal oldest task from others
+		if (offset == 0)
+		{
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		}
+		else
+		{
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		queuedTasks--;
+		return true;
+	}
+	return false;
+}
+
+void ThreadPool::finishTask()
+{
+	if (--unfinishedTasks == 0)
+	{
+		std::lock_guard<std::mutex> lock(wakeMutex);
+		doneCondition.notify_all();
+	}
+}
@@ -0,0 +1,34 @@
+#include "UniformBufferGL.h"
+#include "glad.h" // Opengl function loader
+#include <cstring>
+
+UniformBufferGL::UniformBufferGL(size_t size) : bufferID(0), content(size), isWritten(false)
+{
+	glGenBuffers(1, &bufferID);
+	glBindBuffer(GL_UNIFORM_BUFFER, bufferID);
+	glBufferData(GL_UNIFORM_BUFFER, size, nullptr, GL_DYNAMIC_DRAW);
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+}
+
+UniformBufferGL::~UniformBufferGL()
+{
+	glDeleteBuffers(1, &bufferID);
+}
+
+bool UniformBufferGL::update(void const* data)
+{
+	if (isWritten && memcmp(content.data(), data, content.size()) == 0)
+		return false;
+
+	memcpy(content.data(), data, content.size());
+	isWritten = true;
+	glBindBuffer(GL_UNIFORM_BUFFER, bufferID);
+	glBufferSubData(GL_UNIFORM_BUFFER, 0, content.size(), content.data());
+	glBindBuffer(GL_UNIFORM_BUFFER, 0);
+	return true;
+}
+
+void UniformBufferGL::bind(int bindingPoint) const
+{
+	glBindBufferBase(GL_UNIFORM_BUFFER, bindingPoint, bufferID);
+}
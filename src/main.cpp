@@ -2,14 +2,31 @@
 #include <gtc/matrix_transform.hpp>
 #include <fwd.hpp> //GLM
 #include <iostream>
+#include <cstring>
 #include <map>
+#include <chrono>
+#include <thread>
+#include <future>
+#include <memory>
+#include <algorithm>
 #include "Utils.h"
 #include "ModelLoader.h"
 #include "glad.h" // Opengl function loader
 #include "BVHBuilder.h"
 #include "TextureGL.h"
 #include "ShaderProgram.h"
+#include "UniformBufferGL.h"
 #include "SDLHelper.h"
+#include "CpuRenderer.h"
+#include "ThreadPool.h"
+#include "ImageWriter.h"
+#include "Benchmark.h"
+#include "MeshAttributes.h"
+#include "IndexedMesh.h"
+#include "DecompressStream.h"
+#include "FrameProfiler.h"
+#include "RenderTargetGL.h"
+#include "RenderScale.h"
 
 
 using std::vector;
@@ -27,31 +44,138 @@ constexpr int WinHeight = 1080;
 std::map<int, bool> buttinInputKeys; //keyboard key
 float yaw = 0.0f;          // for cam rotate
 float pitch = 0.0f;        // for cam rotate
+vec3 const startLocation = vec3(0, 0.1, -20);
 
 
-TextureGL BVHNodesToTexture(BVHBuilder& bvh)
+// False if file gave no triangles, BVH and attributes are not built then. Attributes must reference mesh
+bool loadModel(BVHBuilder& bvh, MeshAttributes& attributes, std::string const& path, ThreadPool& pool, IndexedMesh& mesh)
 {
-	float const* texNodeData = (float*)(bvh.bvhToTexture());
-	int texWidthNode = bvh.getNodesSize();
-	return TextureGL(texWidthNode, texWidthNode, TextureGLType::VertexDataXYZ, texNodeData);
+	std::string format = DecompressStream::withoutCompression(path); // "model.ply.zst" is PLY
+	auto hasExtension = [&format](char const* extension)
+	{
+		size_t length = strlen(extension);
+		return format.size() >= length && format.compare(format.size() - length, length, extension) == 0;
+	};
+
+	if (hasExtension(".ply"))
+		ModelLoader::PlyIndexed(path, mesh);
+	else if (hasExtension(".glb"))
+		ModelLoader::Gltf(path, mesh);
+	else
+		ModelLoader::ObjIndexed(path, mesh, &pool);
+	std::cout << path << ": " << mesh.getTriangleCount() << " triangles, " << mesh.getVertexCount() << " unique vertices" << std::endl;
+	if (mesh.getTriangleCount() == 0)
+	{
+		std::cerr << path << ": no triangles to render" << std::endl;
+		return false;
+	}
+
+	bvh.build(mesh);
+	attributes.build(&pool);
+	return true;
+}
+
+
+// Texture data without padding, 2D textures pad only inside last row or layer on upload
+struct GeometryStaging
+{
+	int vertexCount;
+	int triangleCount;
+	vector<float> position;     // x,y,z of unique vertex
+	vector<uint16_t> attribute; // same texel index as position
+	vector<uint32_t> index;     // 3 vertex index of triangle in one texel
+	vector<uint32_t> node;      // 2 texels per BVH node
+};
+
+
+// Position and index are moved from mesh, so they are not held twice. Attributes are not resolved after
+GeometryStaging stageGeometry(IndexedMesh&& mesh, MeshAttributes const& attributes)
+{
+	GeometryStaging staging;
+	staging.vertexCount = (int)mesh.getVertexCount();
+	staging.triangleCount = (int)mesh.getTriangleCount();
+	staging.attribute = attributes.getPacked(); // normal and uv to r,g,b,a
+	staging.position = mesh.takePosition(); // pack x,y,z to r,g,b
+	staging.index = mesh.takeIndex();
+	return staging;
 }
 
 
-TextureGL loadGeometry(BVHBuilder& bvh, std::string const& path)
+struct GeometryTextures
 {
-	vector<float> vertex;
-	vector<float> normal;
-	vector<float> uv;
+	TextureGL position;  // unique vertices
+	TextureGL index;     // 3 vertex index of triangle in one texel
+	TextureGL attribute; // same texel index as position
+	TextureGL node;      // BVH
 
-	ModelLoader::Obj(path, vertex, normal, uv);
-	bvh.build(vertex);
+	size_t getMemorySize() const { return position.getMemorySize() + index.getMemorySize() + attribute.getMemorySize() + node.getMemorySize(); }
+};
+
+
+// std140 layout of FrameState block in raytracing.frag
+struct FrameUniforms
+{
+	vec4 viewToWorld[3]; // mat3 column is padded to vec4
+	vec3 location;
+	float padding0;
+	vec2 screeResolution;
+	vec2 padding1;
+};
+static_assert(sizeof(FrameUniforms) == 80, "FrameUniforms must match std140 FrameState");
+
+
+// Subpixel offset of accumulated sample in [-0.5, 0.5), Halton base 2 and 3. First sample is pixel center
+vec2 sampleJitter(int sampleIndex)
+{
+	auto halton = [](int index, int base)
+	{
+		float fraction = 1.0f;
+		float result = 0.0f;
+		for (; index > 0; index /= base)
+		{
+			fraction /= base;
+			result += fraction * (index % base);
+		}
+		return result;
+	};
+	return sampleIndex == 0 ? vec2(0.0f) : vec2(halton(sampleIndex, 2), halton(sampleIndex, 3)) - 0.5f;
+}
+
+
+// CPU part of scene load, runs on loader thread while window shows placeholder
+struct SceneStaging
+{
+	std::unique_ptr<BVHBuilder> bvh; // null if model could not be loaded
+	GeometryStaging geometry;
+};
+
+
+SceneStaging stageScene(std::string const& path)
+{
+	SceneStaging scene;
+	scene.bvh = std::make_unique<BVHBuilder>(); // Big object
+	ThreadPool pool; // only for parse
+	IndexedMesh mesh;
+	MeshAttributes attributes(mesh);
+	if (!loadModel(*scene.bvh, attributes, path, pool, mesh))
+	{
+		scene.bvh.reset();
+		return scene;
+	}
+	scene.geometry = stageGeometry(std::move(mesh), attributes);
+	scene.bvh->packNodes(scene.geometry.node);
+	return scene;
+}
 
-	uint32_t vertexCount = vertex.size() / 3; // 3 vertex component x,y,z
-	int sqrtVertexCount = ceil(sqrt(vertexCount)); // for sqrt demension 
-	int texWidthPos = Utils::powerOfTwo(sqrtVertexCount); // texture demension sqrt
-	vertex.resize(texWidthPos * texWidthPos * 3, 0.0); // for pack x,y,z to  r,g,b
 
-	return TextureGL(texWidthPos, texWidthPos, TextureGLType::VertexDataXYZ, vertex.data());
+// GL thread only
+GeometryTextures uploadGeometry(GeometryStaging const& staging, TextureGLStorage storage)
+{
+	return {
+		TextureGL(TextureGLType::VertexDataXYZ, storage, staging.vertexCount, staging.position.data()),
+		TextureGL(TextureGLType::IndexUint3, storage, staging.triangleCount, staging.index.data()),
+		TextureGL(TextureGLType::VertexDataHalf4, storage, staging.vertexCount, staging.attribute.data()),
+		TextureGL(TextureGLType::NodeUint4, storage, (int)staging.node.size() / 4, staging.node.data()) };
 }
 
 
@@ -93,8 +217,141 @@ void cameraMove(vec3& location, glm::mat3 const& viewToWorld)
 }
 
 
+// Command line option "--name value"
+bool hasArgument(int argCount, char** args, std::string const& name)
+{
+	for (int index = 1; index < argCount; index++)
+		if (name == args[index])
+			return true;
+	return false;
+}
+
+
+std::string getArgument(int argCount, char** args, std::string const& name, std::string const& defaultValue)
+{
+	for (int index = 1; index < argCount - 1; index++)
+		if (name == args[index])
+			return args[index + 1];
+	return defaultValue;
+}
+
+
+// Shader variant for loaded scene: stack fit BVH depth, unused paths are compiled out
+ShaderDefines traceShaderDefines(BVHBuilder const& bvh, bool isBuffer, int argCount, char** args)
+{
+	ShaderDefines defines;
+	defines["STACK_SIZE"] = std::to_string(bvh.getTreeDepth() + 1);
+	if (isBuffer)
+		defines["BUFFER_TEXTURES"] = "";
+	if (getArgument(argCount, args, "--trace", "closest") == "any")
+		defines["TRACE_ANY_HIT"] = "";
+	if (getArgument(argCount, args, "--view", "normal") == "visits")
+		defines["SHOW_NODE_VISITS"] = "";
+	return defines;
+}
+
+
+// Render nodes without GPU: trace frames with CpuRenderer, print fps and save last frame
+int renderHeadless(int argCount, char** args)
+{
+	int frameCount = std::stoi(getArgument(argCount, args, "--frames", "10"));
+	int threadCount = std::stoi(getArgument(argCount, args, "--threads", std::to_string(std::thread::hardware_concurrency())));
+	int tileSize = std::stoi(getArgument(argCount, args, "--tile", "16"));
+	std::string modelPath = getArgument(argCount, args, "--model", "models/BullPlane.obj");
+	std::string outputPath = getArgument(argCount, args, "--out", "cpu_render.png");
+	std::string intersect = getArgument(argCount, args, "--intersect", "watertight");
+
+	std::unique_ptr<BVHBuilder> bvh = std::make_unique<BVHBuilder>(); // Big object
+	ThreadPool pool(threadCount);
+	IndexedMesh mesh;
+	MeshAttributes attributes(mesh);
+	if (!loadModel(*bvh, attributes, modelPath, pool, mesh))
+		return -1;
+
+	if (intersect == "classic")
+		bvh->setTriangleIntersect(TriangleIntersect::Classic);
+	if (intersect == "precomputed")
+		bvh->setTriangleIntersect(TriangleIntersect::Precomputed);
+
+	CpuRenderer renderer(*bvh, attributes, WinWidth, WinHeight, tileSize);
+	renderer.setFrustumCulling(hasArgument(argCount, args, "--frustum"));
+	vec3 location = startLocation;
+	mat3 viewToWorld = mat3(1.0f);
+
+	renderer.render(pool, location, viewToWorld); // warm up
+	auto start = std::chrono::steady_clock::now();
+	for (int frame = 0; frame < frameCount; frame++)
+		renderer.render(pool, location, viewToWorld);
+	std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+
+	double frameTime = elapsed.count() / std::max(frameCount, 1);
+	std::cout << "CPU render " << WinWidth << "x" << WinHeight << ", " << pool.getThreadCount() << " threads, tile " << tileSize << ", " << intersect << " triangle test" << std::endl;
+	std::cout << "Frame time " << frameTime * 1000.0 << " ms, " << 1.0 / frameTime << " fps" << std::endl;
+	std::cout << "Node visits per ray " << renderer.getNodeVisitsPerRay() << std::endl;
+
+	if (!ImageWriter::ByExtension(outputPath, renderer.getWidth(), renderer.getHeight(), renderer.getImage()))
+		return -1;
+	return 0;
+}
+
+
+// Headless measurements selected by "--bench name"
+int runBenchmark(int argCount, char** args)
+{
+	std::string name = getArgument(argCount, args, "--bench", "");
+	int threadCount = std::stoi(getArgument(argCount, args, "--threads", std::to_string(std::thread::hardware_concurrency())));
+	int repeatCount = std::stoi(getArgument(argCount, args, "--repeat", "5"));
+	std::string modelPath = getArgument(argCount, args, "--model", "models/BullPlane.obj");
+
+	if (name == "rays")
+	{
+		int rayCount = std::stoi(getArgument(argCount, args, "--rays", "1000000"));
+		std::unique_ptr<BVHBuilder> bvh = std::make_unique<BVHBuilder>();
+		ThreadPool pool(threadCount);
+		IndexedMesh mesh;
+		MeshAttributes attributes(mesh);
+		if (!loadModel(*bvh, attributes, modelPath, pool, mesh))
+			return -1;
+		Benchmark::rayStream(*bvh, attributes, pool, startLocation, rayCount, repeatCount);
+		return 0;
+	}
+
+	if (name == "load")
+	{
+		double startMemory = Benchmark::peakMemoryMB();
+		auto start = std::chrono::steady_clock::now();
+		std::unique_ptr<BVHBuilder> bvh = std::make_unique<BVHBuilder>();
+		ThreadPool pool(threadCount);
+		IndexedMesh mesh;
+		MeshAttributes attributes(mesh);
+		if (!loadModel(*bvh, attributes, modelPath, pool, mesh))
+			return -1;
+		GeometryStaging staging = stageGeometry(std::move(mesh), attributes);
+		std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+		std::cout << "Load " << elapsed.count() * 1000.0 << " ms, peak memory " << startMemory << " -> " << Benchmark::peakMemoryMB() << " MB" << std::endl;
+		return 0;
+	}
+
+	if (name == "obj")
+	{
+		ThreadPool pool(threadCount);
+		Benchmark::objLoader(pool, modelPath, repeatCount);
+		return 0;
+	}
+
+	std::cerr << "Unknown benchmark " << name << std::endl;
+	return -1;
+}
+
+
 int main(int ArgCount, char** Args)
 {
+	if (hasArgument(ArgCount, Args, "--cpu"))
+		return renderHeadless(ArgCount, Args);
+
+	if (hasArgument(ArgCount, Args, "--bench"))
+		return runBenchmark(ArgCount, Args);
+
 	// Set Opengl Specification
 	SDL_Init(SDL_INIT_EVERYTHING);
 	SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
@@ -127,14 +384,21 @@ int main(int ArgCount, char** Args)
 	uint32_t VAO;
 	glGenVertexArrays(1, &VAO);
 
-	// Load geometry, build BVH && and load data to texture
-	BVHBuilder* bvh = new BVHBuilder(); // Big object
-	TextureGL texPos = loadGeometry(*bvh, "models/BullPlane.obj");
-	TextureGL texNode = BVHNodesToTexture(*bvh);
-	ShaderProgram shaderProgram("shaders/vertex.vert", "shaders/raytracing.frag");
+	// Load geometry and build BVH on loader thread, textures are created when it is done
+	std::string modelPath = getArgument(ArgCount, Args, "--model", "models/BullPlane.obj");
+	bool isBufferAsked = getArgument(ArgCount, Args, "--textures", "2d") == "buffer";
+	auto startTime = std::chrono::steady_clock::now();
+	std::future<SceneStaging> sceneLoad = std::async(std::launch::async, stageScene, modelPath);
+	SceneStaging scene;
+	std::unique_ptr<GeometryTextures> geometry;
+	GLsync uploadFence = nullptr;
+	bool isSceneReady = false;
+	bool isFirstFrame = true;
+	std::unique_ptr<ShaderProgram> shaderProgram; // compiled for texture kind chosen at upload
+	UniformBufferGL frameBuffer(sizeof(FrameUniforms));
 
 	// Variable for camera  
-	vec3 location = vec3(0, 0.1, -20);
+	vec3 location = startLocation;
 	mat3 viewToWorld = mat3(1.0f);
 
 	// Add value  in map
@@ -145,34 +409,99 @@ int main(int ArgCount, char** Args)
 	buttinInputKeys[SDLK_q] = false;
 	buttinInputKeys[SDLK_e] = false;
 
+	// CPU sections and GPU passes of frame, statistics every 100 frames and optional CSV of every frame
+	enum { ProfileEvents, ProfileUniforms, ProfileSwap };
+	enum { ProfileTrace, ProfileUpsample };
+	FrameProfiler profiler({ "events", "uniforms", "swap" }, { "trace", "upsample" }, 100, getArgument(ArgCount, Args, "--profile", ""));
+
+	// Progressive mode: still camera adds jittered samples to float target as running mean, tracing stops after --accumulate samples
+	int accumulateSamples = std::stoi(getArgument(ArgCount, Args, "--accumulate", "0"));
+	std::unique_ptr<RenderTargetGL> accumulation;
+	if (accumulateSamples > 0)
+		accumulation = std::make_unique<RenderTargetGL>(WinWidth, WinHeight, std::vector<uint32_t>{ GL_RGBA32F });
+	int sampleIndex = 0;
+	bool isIdle = false;    // image converged and camera still, loop sleeps until input
+	bool isExposed = false; // window needs converged image again
+
+	// Dynamic resolution: trace into bottom left part of low resolution target, its size follow GPU time to --budget ms
+	double frameBudget = std::stod(getArgument(ArgCount, Args, "--budget", "0"));
+	if (frameBudget > 0.0 && accumulation)
+	{
+		std::cerr << "--budget is ignored with --accumulate" << std::endl;
+		frameBudget = 0.0;
+	}
+	RenderScale renderScale(frameBudget);
+	std::unique_ptr<RenderTargetGL> lowResolution; // color and surface normal with hit distance for edge aware upsampling
+	std::unique_ptr<ShaderProgram> upsampleProgram;
+	if (frameBudget > 0.0)
+	{
+		lowResolution = std::make_unique<RenderTargetGL>(WinWidth, WinHeight, std::vector<uint32_t>{ GL_RGBA8, GL_RGBA16F });
+		upsampleProgram = std::make_unique<ShaderProgram>("shaders/vertex.vert", "shaders/upsample.frag");
+	}
+
 	// Event loop
 	SDL_Event Event;
 	auto keyIsInside = [&Event] {return buttinInputKeys.count(Event.key.keysym.sym); }; // check key inside in buttinInputKeys
 
 	while (true)
 	{
-		while (SDL_PollEvent(&Event))
+		if (isIdle)
+			SDL_WaitEvent(nullptr);
+		profiler.beginFrame();
 		{
-			if (Event.type == SDL_QUIT)
-				return 0;
+			FrameProfiler::Scope scope(profiler, ProfileEvents);
+			while (SDL_PollEvent(&Event))
+			{
+				if (Event.type == SDL_QUIT)
+					return 0;
 
-			if (Event.type == SDL_MOUSEMOTION) {
-				pitch += Event.motion.yrel * 0.03;
-				yaw += Event.motion.xrel * 0.03;
-			}
+				if (Event.type == SDL_MOUSEMOTION) {
+					pitch += Event.motion.yrel * 0.03;
+					yaw += Event.motion.xrel * 0.03;
+				}
+
+				if (Event.type == SDL_KEYDOWN && keyIsInside())
+					buttinInputKeys[Event.key.keysym.sym] = true;
 
-			if (Event.type == SDL_KEYDOWN && keyIsInside())
-				buttinInputKeys[Event.key.keysym.sym] = true;
+				if (Event.type == SDL_KEYUP && keyIsInside())
+					buttinInputKeys[Event.key.keysym.sym] = false;
+
+				if (Event.type == SDL_KEYDOWN && Event.key.keysym.sym == SDLK_ESCAPE)
+					return 0;
+
+				if (Event.type == SDL_WINDOWEVENT && Event.window.event == SDL_WINDOWEVENT_EXPOSED)
+					isExposed = true;
+			}
 
-			if (Event.type == SDL_KEYUP && keyIsInside())
-				buttinInputKeys[Event.key.keysym.sym] = false;
+			cameraMove(location, viewToWorld);
+			updateMatrix(viewToWorld);
+		}
 
-			if (Event.type == SDL_KEYDOWN && Event.key.keysym.sym == SDLK_ESCAPE)
-				return 0;
+		// Staged scene is uploaded once, it is drawn only after fence say GPU has the textures
+		if (!geometry && sceneLoad.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+		{
+			scene = sceneLoad.get();
+			if (!scene.bvh)
+				return -1;
+			int maxTexelCount = std::max({ scene.geometry.vertexCount, scene.geometry.triangleCount, scene.bvh->getNodeCount() * 2 });
+			bool isBuffer = isBufferAsked && TextureGL::isBufferSupported(maxTexelCount);
+			if (isBufferAsked && !isBuffer)
+				std::cerr << "RGB32F buffer textures are not supported or scene is too big, 2D textures are used" << std::endl;
+
+			geometry = std::make_unique<GeometryTextures>(uploadGeometry(scene.geometry, isBuffer ? TextureGLStorage::Buffer : TextureGLStorage::Array2D));
+			shaderProgram = std::make_unique<ShaderProgram>("shaders/vertex.vert", "shaders/raytracing.frag", traceShaderDefines(*scene.bvh, isBuffer, ArgCount, Args));
+			std::cout << (isBuffer ? "Buffer" : "2D") << " textures " << geometry->getMemorySize() / (1024.0 * 1024.0) << " MB" << std::endl;
+			scene.geometry = GeometryStaging(); // free staging memory
+			uploadFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+			glFlush(); // fence must reach GPU, it is polled without flush bit
 		}
 
-		cameraMove(location, viewToWorld);
-		updateMatrix(viewToWorld);
+		if (uploadFence && glClientWaitSync(uploadFence, 0, 0) != GL_TIMEOUT_EXPIRED)
+		{
+			glDeleteSync(uploadFence);
+			uploadFence = nullptr;
+			isSceneReady = true;
+		}
 
 		// Render/Draw
 		// Clear the colorbuffer
@@ -180,18 +509,105 @@ int main(int ArgCount, char** Args)
 		glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
 		glClear(GL_COLOR_BUFFER_BIT);
 
-		shaderProgram.bind();
+		// Placeholder is the clear color until scene is ready
+		if (!isSceneReady)
+		{
+			{
+				FrameProfiler::Scope scope(profiler, ProfileSwap);
+				SDL_GL_SwapWindow(window);
+			}
+			profiler.endFrame();
+			if (isFirstFrame)
+				std::cout << "Time to first frame " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() << " ms" << std::endl;
+			isFirstFrame = false;
+			continue;
+		}
+
+		auto& [texPos, texIndex, texAttribute, texNode] = *geometry;
+		int renderWidth = WinWidth;
+		int renderHeight = WinHeight;
+		if (lowResolution)
+		{
+			renderScale.update(profiler.takePassTime(ProfileTrace) + profiler.takePassTime(ProfileUpsample));
+			renderWidth = renderScale.scaled(WinWidth);
+			renderHeight = renderScale.scaled(WinHeight);
+		}
+		shaderProgram->bind();
 		glBindVertexArray(VAO);
 		// Set shader variable
-		shaderProgram.setTextureAI("texPosition", texPos);
-		shaderProgram.setTextureAI("texNode", texNode);
-		shaderProgram.setMatrix3x3("viewToWorld", viewToWorld);
-		shaderProgram.setVec3("location", location);
-		shaderProgram.setVec2("screeResolution", vec2(WinWidth, WinHeight));
-		shaderProgram.setInt("bvhWidth", texNode.getWidth());
-		shaderProgram.setInt("texPosWidth", texPos.getWidth());
+		{
+			FrameProfiler::Scope scope(profiler, ProfileUniforms);
+			shaderProgram->setTextureAI("texPosition", texPos);
+			shaderProgram->setTextureAI("texNode", texNode);
+			shaderProgram->setTextureAI("texIndex", texIndex);
+			shaderProgram->setTextureAI("texAttribute", texAttribute);
+			FrameUniforms frame = {};
+			for (int column = 0; column < 3; column++)
+				frame.viewToWorld[column] = vec4(viewToWorld[column], 0.0f);
+			frame.location = location;
+			frame.screeResolution = vec2(renderWidth, renderHeight);
+			if (frameBuffer.update(&frame))
+				sampleIndex = 0; // camera moved, accumulated image is stale
+			shaderProgram->setUniformBlock("FrameState", frameBuffer, 0);
+			shaderProgram->setVec2("jitter", accumulation ? sampleJitter(sampleIndex) : vec2(0.0f));
+			shaderProgram->setIVec2("bvhShift", glm::ivec2(texNode.getWidthShift(), texNode.getLayerShift()));
+			shaderProgram->setIVec2("texPosShift", glm::ivec2(texPos.getWidthShift(), texPos.getLayerShift()));
+			shaderProgram->setIVec2("texIndexShift", glm::ivec2(texIndex.getWidthShift(), texIndex.getLayerShift()));
+		}
+		isIdle = accumulation && sampleIndex >= accumulateSamples;
+		if (isIdle && !isExposed)
+		{
+			profiler.endFrame();
+			continue;
+		}
+		isExposed = false;
+
 		// Draw
-		glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
-		SDL_GL_SwapWindow(window);
+		if (!isIdle)
+		{
+			if (accumulation)
+			{
+				accumulation->bind();
+				glEnable(GL_BLEND);
+				glBlendColor(0.0f, 0.0f, 0.0f, 1.0f / (sampleIndex + 1)); // first sample replaces old image
+				glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+				sampleIndex++;
+			}
+			if (lowResolution)
+				lowResolution->bind(renderWidth, renderHeight);
+			profiler.beginPass(ProfileTrace);
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			profiler.endPass();
+		}
+		if (accumulation)
+		{
+			glDisable(GL_BLEND);
+			accumulation->blitToScreen(WinWidth, WinHeight);
+		}
+		if (lowResolution)
+		{
+			glBindFramebuffer(GL_FRAMEBUFFER, 0);
+			glViewport(0, 0, WinWidth, WinHeight);
+			upsampleProgram->bind();
+			upsampleProgram->setTexture("lowColor", lowResolution->getTextureID(0), 0);
+			upsampleProgram->setTexture("lowSurface", lowResolution->getTextureID(1), 1);
+			upsampleProgram->setIVec2("renderSize", glm::ivec2(renderWidth, renderHeight));
+			upsampleProgram->setVec2("windowSize", vec2(WinWidth, WinHeight));
+			profiler.beginPass(ProfileUpsample);
+			glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+			profiler.endPass();
+		}
+		{
+			FrameProfiler::Scope scope(profiler, ProfileSwap);
+			SDL_GL_SwapWindow(window);
+		}
+		profiler.endFrame();
+
+		if (isFirstFrame || scene.bvh)
+		{
+			std::cout << "Time to first scene frame " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count() << " ms" << std::endl;
+			scene.bvh.reset(); // CPU copy of BVH is not used by GPU renderer
+			isFirstFrame = false;
+		}
 	}
 }
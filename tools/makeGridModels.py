@@ -0,0 +1,83 @@
+#!/usr/bin/env python3
+# Writes large test models for loader timing: UV sphere of N x N quads as OBJ (v/vt/vn, triangles) and
+# binary_little_endian PLY (float x y z nx ny nz s t, uchar int quads), each also as .gz and .zst when zstd is installed.
+#
+#     tools/makeGridModels.py [--size 700] [--out models]
+#
+# Outputs are models/_grid.obj and models/_grid_le.ply, they are ignored by git.
+import argparse
+import gzip
+import math
+import os
+import shutil
+import struct
+import subprocess
+
+Radius = 5.0
+
+
+def gridVertices(size):
+	for row in range(size + 1):
+		theta = math.pi * row / size
+		for column in range(size + 1):
+			phi = 2.0 * math.pi * column / size
+			normal = (math.sin(theta) * math.cos(phi), math.cos(theta), math.sin(theta) * math.sin(phi))
+			yield [Radius * value for value in normal], normal, (column / size, row / size)
+
+
+def gridQuads(size):
+	for row in range(size):
+		for column in range(size):
+			first = row * (size + 1) + column
+			yield first, first + size + 1, first + size + 2, first + 1
+
+
+def writeObj(path, size):
+	with open(path, "w") as file:
+		for position, normal, uv in gridVertices(size):
+			file.write("v %f %f %f\nvt %f %f\nvn %f %f %f\n" % (*position, *uv, *normal))
+		for a, b, c, d in gridQuads(size):
+			a, b, c, d = a + 1, b + 1, c + 1, d + 1
+			file.write("f %d/%d/%d %d/%d/%d %d/%d/%d\n" % (a, a, a, b, b, b, d, d, d))
+			file.write("f %d/%d/%d %d/%d/%d %d/%d/%d\n" % (d, d, d, b, b, b, c, c, c))
+
+
+def writePly(path, size):
+	header = ("ply\nformat binary_little_endian 1.0\nelement vertex %d\n" % ((size + 1) ** 2)
+		+ "".join("property float %s\n" % name for name in ("x", "y", "z", "nx", "ny", "nz", "s", "t"))
+		+ "element face %d\nproperty list uchar int vertex_indices\nend_header\n" % (size * size))
+	vertex = struct.Struct("<8f")
+	quad = struct.Struct("<B4i")
+	with open(path, "wb") as file:
+		file.write(header.encode("ascii"))
+		file.write(b"".join(vertex.pack(*position, *normal, *uv) for position, normal, uv in gridVertices(size)))
+		file.write(b"".join(quad.pack(4, *corners) for corners in gridQuads(size)))
+
+
+def compress(path):
+	with open(path, "rb") as source, gzip.open(path + ".gz", "wb") as target:
+		shutil.copyfileobj(source, target)
+	if shutil.which("zstd"):
+		subprocess.run(["zstd", "-q", "-f", path, "-o", path + ".zst"], check=True)
+	else:
+		print("zstd not found, " + path + ".zst is not written")
+
+
+def main():
+	parser = argparse.ArgumentParser(description="Write grid test models")
+	parser.add_argument("--size", type=int, default=700, help="quads per side")
+	parser.add_argument("--out", default=os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "models"))
+	arguments = parser.parse_args()
+
+	os.makedirs(arguments.out, exist_ok=True)
+	objPath = os.path.join(arguments.out, "_grid.obj")
+	plyPath = os.path.join(arguments.out, "_grid_le.ply")
+	writeObj(objPath, arguments.size)
+	writePly(plyPath, arguments.size)
+	for path in (objPath, plyPath):
+		compress(path)
+		print(path)
+
+
+if __name__ == "__main__":
+	main()